@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_Atomic128.dir/bench/Atomic128.cpp.o"
+  "CMakeFiles/bench_Atomic128.dir/bench/Atomic128.cpp.o.d"
+  "bench_Atomic128"
+  "bench_Atomic128.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_Atomic128.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
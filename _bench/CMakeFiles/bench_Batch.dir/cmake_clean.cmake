@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_Batch.dir/bench/Batch.cpp.o"
+  "CMakeFiles/bench_Batch.dir/bench/Batch.cpp.o.d"
+  "bench_Batch"
+  "bench_Batch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_Batch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_Keys.dir/bench/Keys.cpp.o"
+  "CMakeFiles/bench_Keys.dir/bench/Keys.cpp.o.d"
+  "bench_Keys"
+  "bench_Keys.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_Keys.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
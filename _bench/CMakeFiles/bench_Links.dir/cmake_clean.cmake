@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_Links.dir/bench/Links.cpp.o"
+  "CMakeFiles/bench_Links.dir/bench/Links.cpp.o.d"
+  "bench_Links"
+  "bench_Links.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_Links.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_Pop.dir/bench/Pop.cpp.o"
+  "CMakeFiles/bench_Pop.dir/bench/Pop.cpp.o.d"
+  "bench_Pop"
+  "bench_Pop.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_Pop.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
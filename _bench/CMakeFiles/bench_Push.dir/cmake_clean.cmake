@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_Push.dir/bench/Push.cpp.o"
+  "CMakeFiles/bench_Push.dir/bench/Push.cpp.o.d"
+  "bench_Push"
+  "bench_Push.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_Push.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
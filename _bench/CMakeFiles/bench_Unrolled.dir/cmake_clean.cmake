@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_Unrolled.dir/bench/Unrolled.cpp.o"
+  "CMakeFiles/bench_Unrolled.dir/bench/Unrolled.cpp.o.d"
+  "bench_Unrolled"
+  "bench_Unrolled.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_Unrolled.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
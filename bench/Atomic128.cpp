@@ -0,0 +1,95 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "CSLPQ/Atomic128.hpp"
+
+#define COUNT 10000000
+
+// Load throughput on one 16 byte atomic shared by every thread, as on the head of a queue: every thread loads it
+// COUNT times, with Load (a vector load where the processor makes it atomic) or LoadLocked (always cmpxchg16b),
+// with and without one more thread storing to it all the while. Both halves of every stored value are equal, so a
+// load that sees them differ was torn.
+pthread_barrier_t barrier;
+
+struct alignas(16) Pair
+{
+    uint64_t low;
+    uint64_t high;
+};
+
+void load(A128::Atomic128<Pair>& atomic, bool locked, uint64_t& torn)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        Pair pair = locked? atomic.LoadLocked() : atomic.Load();
+        torn += pair.low != pair.high;
+    }
+}
+
+void store(A128::Atomic128<Pair>& atomic, std::atomic<bool>& done)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 1; !done.load(std::memory_order_relaxed); i++)
+    {
+        atomic.Store(Pair{i, i});
+    }
+}
+
+void run(const std::string& name, uint32_t threads, bool locked, bool writer)
+{
+    A128::Atomic128<Pair> atomic(Pair{0, 0});
+    std::atomic<bool> done(false);
+    pthread_barrier_init(&barrier, NULL, threads + writer + 1);
+    std::vector<uint64_t> torn(threads, 0);
+    std::vector<std::thread> ts;
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        ts.emplace_back(load, std::ref(atomic), locked, std::ref(torn[i]));
+    }
+    std::thread storer;
+    if (writer)
+    {
+        storer = std::thread(store, std::ref(atomic), std::ref(done));
+    }
+    pthread_barrier_wait(&barrier);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& t : ts)
+    {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    done.store(true);
+    if (writer)
+    {
+        storer.join();
+    }
+    pthread_barrier_destroy(&barrier);
+
+    uint64_t total_torn = 0;
+    for (uint64_t t : torn)
+    {
+        total_torn += t;
+    }
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::left << std::setw(32) << name << threads << " threads: " << std::fixed << std::setprecision(2)
+              << uint64_t(COUNT) * threads / seconds / 1e6 << " M loads/s, " << total_torn << " torn" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = argc > 1? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    std::cout << "Atomic vector loads: " << (A128::HasAtomicVectorLoad()? "yes" : "no") << std::endl;
+    run("LoadLocked", threads, true, false);
+    run("Load", threads, false, false);
+    run("LoadLocked with a writer", threads, true, true);
+    run("Load with a writer", threads, false, true);
+    return 0;
+}
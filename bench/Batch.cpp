@@ -0,0 +1,84 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "CSLPQ/Queue.hpp"
+
+#define BATCH 256
+#define COUNT 1000000
+
+// Push throughput for batches of nearby keys, like a simulator scheduling a burst of events shortly after the current
+// time: every thread pushes COUNT / threads keys in batches of BATCH, either one Push at a time or with PushBatch.
+pthread_barrier_t barrier;
+
+uint64_t next_key(uint64_t& state)
+{
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return state >> 16;
+}
+
+template<typename Q>
+void push(Q& queue, uint64_t seed, uint64_t count, bool batched)
+{
+    uint64_t state = seed;
+    std::vector<uint64_t> batch(BATCH);
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < count; i += BATCH)
+    {
+        uint64_t now = i * 16;
+        for (uint64_t& key : batch)
+        {
+            key = now + next_key(state) % 4096;
+        }
+        if (batched)
+        {
+            queue.PushBatch(batch.begin(), batch.end());
+        }
+        else
+        {
+            for (uint64_t key : batch)
+            {
+                queue.Push(key);
+            }
+        }
+    }
+}
+
+template<typename Q>
+void run(const std::string& name, uint32_t threads, bool batched)
+{
+    Q queue(16);
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    std::vector<std::thread> ts;
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        ts.emplace_back(push<Q>, std::ref(queue), i + 1, COUNT / threads, batched);
+    }
+    pthread_barrier_wait(&barrier);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& t : ts)
+    {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    pthread_barrier_destroy(&barrier);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::left << std::setw(30) << name << threads << " threads: " << std::fixed << std::setprecision(2)
+              << COUNT / seconds / 1e6 << " M pushes/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = argc > 1? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    run<CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator>>("Push", threads, false);
+    run<CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator>>("PushBatch", threads, true);
+    run<CSLPQ::Queue<uint64_t, CSLPQ::HazardReclamation>>("Push<Hazard>", threads, false);
+    run<CSLPQ::Queue<uint64_t, CSLPQ::HazardReclamation>>("PushBatch<Hazard>", threads, true);
+    return 0;
+}
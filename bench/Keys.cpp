@@ -0,0 +1,120 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "CSLPQ/Queue.hpp"
+
+#define PREFILL 100000
+#define COUNT 200000
+
+// Search cost per key type: every thread alternates pushing a random key into a queue of PREFILL keys and popping the
+// smallest one, COUNT times in total, so nearly all the time goes to the searches of the pushes. The same random
+// numbers become uint64_t keys, std::pair<uint64_t, uint64_t> keys as in test/Func2.cpp, and 20 character strings
+// that are too long to be stored inside the std::string, the strings once more with StringPrefix kept in the nodes.
+pthread_barrier_t barrier;
+
+uint64_t next_random(uint64_t& state)
+{
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return state >> 16;
+}
+
+template<typename K>
+K make_key(uint64_t random);
+
+template<>
+uint64_t make_key<uint64_t>(uint64_t random)
+{
+    return random;
+}
+
+template<>
+std::pair<uint64_t, uint64_t> make_key<std::pair<uint64_t, uint64_t>>(uint64_t random)
+{
+    return std::make_pair(random >> 24, random);
+}
+
+template<>
+std::string make_key<std::string>(uint64_t random)
+{
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "%016llx/job", static_cast<unsigned long long>(random));
+    return buffer;
+}
+
+template<typename K, typename Q>
+void push_pop(Q& queue, const std::vector<K>& keys)
+{
+    K key;
+    pthread_barrier_wait(&barrier);
+    for (const K& pushed : keys)
+    {
+        queue.Push(pushed);
+        queue.TryPop(key);
+    }
+}
+
+template<typename K, typename Q>
+void run(const std::string& name, uint32_t threads)
+{
+    Q queue(16);
+    uint64_t state = 0;
+    for (uint64_t i = 0; i < PREFILL; i++)
+    {
+        queue.Push(make_key<K>(next_random(state)));
+    }
+    // Keys are made up front, so string allocations stay out of the timing
+    std::vector<std::vector<K>> keys(threads);
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        for (uint64_t j = 0; j < COUNT / threads; j++)
+        {
+            keys[i].emplace_back(make_key<K>(next_random(state)));
+        }
+    }
+
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    std::vector<std::thread> ts;
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        ts.emplace_back(push_pop<K, Q>, std::ref(queue), std::cref(keys[i]));
+    }
+    pthread_barrier_wait(&barrier);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& t : ts)
+    {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    pthread_barrier_destroy(&barrier);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::left << std::setw(40) << name << threads << " threads: " << std::fixed << std::setprecision(2)
+              << COUNT / seconds / 1e6 << " M push/pop pairs/s" << std::endl;
+}
+
+template<typename R>
+using PrefixedQueue = CSLPQ::Queue<std::string, R, CSLPQ::DefaultAllocator, 0, std::less<std::string>,
+                                   CSLPQ::ExactCount, CSLPQ::StringPrefix>;
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = argc > 1? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    typedef std::pair<uint64_t, uint64_t> Pair;
+    run<uint64_t, CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation>>("Queue<uint64_t, Epoch>", threads);
+    run<Pair, CSLPQ::Queue<Pair, CSLPQ::EpochReclamation>>("Queue<pair, Epoch>", threads);
+    run<std::string, CSLPQ::Queue<std::string, CSLPQ::EpochReclamation>>("Queue<string, Epoch>", threads);
+    run<std::string, PrefixedQueue<CSLPQ::EpochReclamation>>("Queue<string, Epoch, StringPrefix>", threads);
+    run<uint64_t, CSLPQ::Queue<uint64_t, CSLPQ::HazardReclamation>>("Queue<uint64_t, Hazard>", threads);
+    run<Pair, CSLPQ::Queue<Pair, CSLPQ::HazardReclamation>>("Queue<pair, Hazard>", threads);
+    run<std::string, CSLPQ::Queue<std::string, CSLPQ::HazardReclamation>>("Queue<string, Hazard>", threads);
+    run<std::string, PrefixedQueue<CSLPQ::HazardReclamation>>("Queue<string, Hazard, StringPrefix>", threads);
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "CSLPQ/Queue.hpp"
+
+#define CHAIN 1024
+#define WALKS 1000
+#define PREFILL 100000
+#define COUNT 200000
+
+// Read heavy comparison of the two shared pointer link types. First every thread walks the same chain of CHAIN
+// nodes WALKS times, reading each link with load_marked like a search does, then the same with is_marked only.
+// Last, every thread alternates pushing a random key into a queue of PREFILL keys and popping the smallest one,
+// where the push is a search through all levels, COUNT times in total.
+pthread_barrier_t barrier;
+
+template<template<typename> class L>
+struct ChainNode
+{
+    L<ChainNode> next;
+};
+
+template<template<typename> class L>
+void walk(const jss::shared_ptr<ChainNode<L>>& first, bool marks_only, uint64_t& visited)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < WALKS; i++)
+    {
+        jss::shared_ptr<ChainNode<L>> current = first;
+        while (current)
+        {
+            if (marks_only)
+            {
+                visited += current->next.is_marked();
+                visited++;
+            }
+            current = current->next.load_marked().first;
+            if (!marks_only)
+            {
+                visited++;
+            }
+        }
+    }
+}
+
+template<template<typename> class L>
+void run_chain(const std::string& name, bool marks_only, uint32_t threads)
+{
+    jss::shared_ptr<ChainNode<L>> first(new ChainNode<L>());
+    for (uint64_t i = 1; i < CHAIN; i++)
+    {
+        jss::shared_ptr<ChainNode<L>> node(new ChainNode<L>());
+        node->next.store(first);
+        first = node;
+    }
+
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    std::vector<uint64_t> visited(threads, 0);
+    std::vector<std::thread> ts;
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        ts.emplace_back(walk<L>, std::cref(first), marks_only, std::ref(visited[i]));
+    }
+    pthread_barrier_wait(&barrier);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& t : ts)
+    {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    pthread_barrier_destroy(&barrier);
+
+    // Unlink from the back one at a time, dropping the whole chain at once would recurse through it
+    while (first)
+    {
+        jss::shared_ptr<ChainNode<L>> next = first->next.load();
+        first->next.store(jss::shared_ptr<ChainNode<L>>());
+        first = next;
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::left << std::setw(40) << name << threads << " threads: " << std::fixed << std::setprecision(2)
+              << uint64_t(CHAIN) * WALKS * threads / seconds / 1e6 << " M links/s" << std::endl;
+}
+
+uint64_t next_key(uint64_t& state)
+{
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return state >> 16;
+}
+
+template<typename Q>
+void push_pop(Q& queue, uint64_t seed, uint64_t count)
+{
+    uint64_t state = seed;
+    uint64_t key;
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        queue.Push(next_key(state));
+        queue.TryPop(key);
+    }
+}
+
+template<typename Q>
+void run_queue(const std::string& name, uint32_t threads)
+{
+    Q queue(16);
+    uint64_t state = 0;
+    for (uint64_t i = 0; i < PREFILL; i++)
+    {
+        queue.Push(next_key(state));
+    }
+
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    std::vector<std::thread> ts;
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        ts.emplace_back(push_pop<Q>, std::ref(queue), i + 1, COUNT / threads);
+    }
+    pthread_barrier_wait(&barrier);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& t : ts)
+    {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    pthread_barrier_destroy(&barrier);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::left << std::setw(40) << name << threads << " threads: " << std::fixed << std::setprecision(2)
+              << COUNT / seconds / 1e6 << " M push/pop pairs/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = argc > 1? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    run_chain<jss::markable_atomic_shared_ptr>("Chain load_marked<16 byte>", false, threads);
+    run_chain<jss::tagged_markable_atomic_shared_ptr>("Chain load_marked<8 byte>", false, threads);
+    run_chain<jss::markable_atomic_shared_ptr>("Chain is_marked<16 byte>", true, threads);
+    run_chain<jss::tagged_markable_atomic_shared_ptr>("Chain is_marked<8 byte>", true, threads);
+    run_queue<CSLPQ::Queue<uint64_t, CSLPQ::SharedReclamation>>("Queue<Shared>", threads);
+    run_queue<CSLPQ::Queue<uint64_t, CSLPQ::TaggedSharedReclamation>>("Queue<TaggedShared>", threads);
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 1000000
+#define BATCH 32
+
+// Pop throughput: the queue is filled with COUNT keys, then every thread pops until it is empty. Compares strict
+// pops, which all go for the first node, with sprayed relaxed ones and with strict ones taking BATCH keys at a time.
+pthread_barrier_t barrier;
+
+typedef CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator> Q;
+
+enum Mode
+{
+    Strict,
+    Relaxed,
+    Batched
+};
+
+void pop(Q& queue, Mode mode, uint32_t threads)
+{
+    uint64_t key;
+    uint64_t keys[BATCH];
+    pthread_barrier_wait(&barrier);
+    while (queue.GetSize())
+    {
+        switch (mode)
+        {
+            case Strict:
+                queue.TryPop(key);
+                break;
+            case Relaxed:
+                queue.TryPopRelaxed(key, threads);
+                break;
+            case Batched:
+                queue.TryPopN(keys, BATCH);
+                break;
+        }
+    }
+}
+
+void run(const std::string& name, Mode mode, uint32_t threads)
+{
+    Q queue(16);
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        queue.Push(i);
+    }
+
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    std::vector<std::thread> ts;
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        ts.emplace_back(pop, std::ref(queue), mode, threads);
+    }
+    pthread_barrier_wait(&barrier);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& t : ts)
+    {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    pthread_barrier_destroy(&barrier);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::left << std::setw(30) << name << threads << " threads: " << std::fixed << std::setprecision(2)
+              << COUNT / seconds / 1e6 << " M pops/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = argc > 1? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    run("TryPop", Strict, threads);
+    run("TryPopRelaxed", Relaxed, threads);
+    run("TryPopN(32)", Batched, threads);
+    return 0;
+}
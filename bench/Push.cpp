@@ -0,0 +1,83 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "CSLPQ/Queue.hpp"
+
+#define PREFILL 1000
+#define COUNT 1000000
+
+// Push throughput on a queue kept at a steady size: the queue is filled with PREFILL keys, then every thread
+// alternates pushing a random key and popping the smallest one, COUNT / threads times.
+pthread_barrier_t barrier;
+
+uint64_t next_key(uint64_t& state)
+{
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return state >> 16;
+}
+
+template<typename Q>
+void push_pop(Q& queue, uint64_t seed, uint64_t count)
+{
+    uint64_t state = seed;
+    uint64_t key;
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        queue.Push(next_key(state));
+        queue.TryPop(key);
+    }
+}
+
+template<typename Q>
+void run(const std::string& name, uint32_t threads)
+{
+    Q queue(8);
+    uint64_t state = 0;
+    for (uint64_t i = 0; i < PREFILL; i++)
+    {
+        queue.Push(next_key(state));
+    }
+
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    std::vector<std::thread> ts;
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        ts.emplace_back(push_pop<Q>, std::ref(queue), i + 1, COUNT / threads);
+    }
+    pthread_barrier_wait(&barrier);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& t : ts)
+    {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    pthread_barrier_destroy(&barrier);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::left << std::setw(30) << name << threads << " threads: " << std::fixed << std::setprecision(2)
+              << COUNT / seconds / 1e6 << " M push/pop pairs/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = argc > 1? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    run<CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation>>("Queue<Epoch>", threads);
+    run<CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator>>("Queue<Epoch, Pool>", threads);
+    run<CSLPQ::FixedQueue<uint64_t, 8, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator>>("FixedQueue<8, Epoch, Pool>",
+                                                                                   threads);
+    run<CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator, 0, std::less<uint64_t>,
+                     CSLPQ::ShardedCount<>>>("Queue<Epoch, Pool, Sharded>", threads);
+    run<CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator, 0, std::less<uint64_t>,
+                     CSLPQ::NoCount>>("Queue<Epoch, Pool, NoCount>", threads);
+    run<CSLPQ::Queue<uint64_t, CSLPQ::HazardReclamation>>("Queue<Hazard>", threads);
+    run<CSLPQ::Queue<uint64_t>>("Queue<Shared>", threads);
+    return 0;
+}
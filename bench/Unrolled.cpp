@@ -0,0 +1,147 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <iterator>
+#include <cstdlib>
+#include <pthread.h>
+
+#include "CSLPQ/Queue.hpp"
+#include "CSLPQ/UnrolledQueue.hpp"
+
+#define PREFILL 100000
+#define COUNT 400000
+#define BATCH 64
+#define WINDOW 1000
+
+// One node per key against up to BlockSize keys per node. First, every thread alternates pushing a random key into a
+// queue of PREFILL keys and popping the smallest one, COUNT times in total. Then the threads drain COUNT keys with
+// TryPopN, BATCH at a time. Last, a simulator style event queue: every thread pushes keys a little ahead of a shared
+// clock, and pops everything up to the clock with PopAllUpTo whenever it moves it forward by WINDOW. Every push into
+// an UnrolledQueue allocates a new block, so both are also run with the pool allocator.
+pthread_barrier_t barrier;
+
+uint64_t next_key(uint64_t& state)
+{
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return state >> 16;
+}
+
+template<typename Q>
+void push_pop(Q& queue, uint64_t seed, uint64_t count)
+{
+    uint64_t state = seed;
+    uint64_t key;
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        queue.Push(next_key(state));
+        queue.TryPop(key);
+    }
+}
+
+template<typename Q>
+void drain(Q& queue)
+{
+    std::vector<uint64_t> popped;
+    pthread_barrier_wait(&barrier);
+    do
+    {
+        popped.clear();
+    }
+    while (queue.TryPopN(std::back_inserter(popped), BATCH));
+}
+
+template<typename Q>
+void events(Q& queue, std::atomic<uint64_t>& clock, uint64_t seed, uint64_t count)
+{
+    uint64_t state = seed;
+    std::vector<uint64_t> popped;
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t now = clock.load(std::memory_order_relaxed);
+        queue.Push(now + next_key(state) % (16 * WINDOW));
+        if (i % 16 == 15)
+        {
+            now = clock.fetch_add(WINDOW) + WINDOW;
+            popped.clear();
+            queue.PopAllUpTo(now, std::back_inserter(popped));
+        }
+    }
+}
+
+template<typename Q>
+void run(const std::string& name, const std::string& workload, uint32_t threads)
+{
+    Q queue(16);
+    uint64_t state = 0;
+    std::atomic<uint64_t> clock(0);
+    if (workload == "push/pop")
+    {
+        for (uint64_t i = 0; i < PREFILL; i++)
+        {
+            queue.Push(next_key(state));
+        }
+    }
+    else if (workload == "drain")
+    {
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            queue.Push(next_key(state));
+        }
+    }
+
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    std::vector<std::thread> ts;
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        if (workload == "push/pop")
+        {
+            ts.emplace_back(push_pop<Q>, std::ref(queue), i + 1, COUNT / threads);
+        }
+        else if (workload == "drain")
+        {
+            ts.emplace_back(drain<Q>, std::ref(queue));
+        }
+        else
+        {
+            ts.emplace_back(events<Q>, std::ref(queue), std::ref(clock), i + 1, COUNT / threads);
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& t : ts)
+    {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    pthread_barrier_destroy(&barrier);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::left << std::setw(40) << name + " " + workload << threads << " threads: " << std::fixed
+              << std::setprecision(2) << COUNT / seconds / 1e6 << " M ops/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = argc > 1? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    typedef CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation> NodeQueue;
+    typedef CSLPQ::UnrolledQueue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0,
+                                 std::less<uint64_t>, CSLPQ::ExactCount, 8> Unrolled8;
+    typedef CSLPQ::UnrolledQueue<uint64_t, CSLPQ::EpochReclamation> Unrolled16;
+    typedef CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator> PooledNodeQueue;
+    typedef CSLPQ::UnrolledQueue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator> PooledUnrolled16;
+    for (const char* workload : {"push/pop", "drain", "events"})
+    {
+        run<NodeQueue>("Queue", workload, threads);
+        run<Unrolled8>("UnrolledQueue<8>", workload, threads);
+        run<Unrolled16>("UnrolledQueue<16>", workload, threads);
+        run<PooledNodeQueue>("Queue<Pool>", workload, threads);
+        run<PooledUnrolled16>("UnrolledQueue<16, Pool>", workload, threads);
+    }
+    return 0;
+}
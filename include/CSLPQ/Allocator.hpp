@@ -0,0 +1,223 @@
+#ifndef __CSLPQ_ALLOCATOR_HPP__
+#define __CSLPQ_ALLOCATOR_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "Reclamation.hpp"
+
+namespace CSLPQ
+{
+    // An allocator policy hands out the blocks nodes live in. Every policy provides, for a node type N:
+    //  - Allocate<N>(size, level): a block of size bytes for a node with a tower of level links.
+    //  - Free<N>(memory): gives back a block returned by Allocate<N>, from any thread.
+    //  - Reserve<N>(size, level, count): sets aside count more such blocks for the calling thread, if the policy
+    //    keeps any.
+    static const std::size_t cache_line_size = 64;
+
+    inline void* AllocateAligned(std::size_t size)
+    {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, cache_line_size, size))
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    // Straight to the system allocator, one cache line aligned block per node.
+    class DefaultAllocator
+    {
+        public:
+            template<typename N>
+            static void* Allocate(std::size_t size, int)
+            {
+                return AllocateAligned(size);
+            }
+
+            template<typename N>
+            static void Free(void* memory)
+            {
+                free(memory);
+            }
+
+            template<typename N>
+            static void Reserve(std::size_t, int, std::size_t)
+            {
+            }
+    };
+
+    // Per thread free lists, one per tower height, so a freed node is reused as is by the next node of the same
+    // height. Every block remembers the pool it was carved from, and a block freed by another thread goes back to
+    // that pool through a lock-free stack the owner drains when its own list runs dry. Producers therefore keep
+    // reusing their own memory no matter which thread popped and freed it.
+    //
+    // Pools are kept per node type and never given back to the system: a thread that exits leaves its pool, blocks
+    // included, to the next thread that needs one. Blocks carry a small header in front of the node, which still
+    // leaves the key and the first links of small nodes in the block's first cache line.
+    class PoolAllocator
+    {
+        private:
+            struct Pool;
+
+            struct alignas(16) Header
+            {
+                Pool* owner;
+                uint32_t height;
+            };
+
+            // What a free block holds in place of the node
+            struct Block
+            {
+                Block* next;
+            };
+
+            static Header* GetHeader(void* memory)
+            {
+                return reinterpret_cast<Header*>(static_cast<char*>(memory) - sizeof(Header));
+            }
+
+            // Tells threads apart. It is trivially destructible, so it stays usable during static destruction.
+            static const char* GetThreadToken()
+            {
+                static thread_local char token;
+                return &token;
+            }
+
+            struct Pool : public ThreadRecord
+            {
+                std::vector<Block*> local;
+                std::atomic<Block*> remote;
+                // Token of the thread holding the pool, null once it let go of it
+                std::atomic<const char*> holder;
+
+                Pool() : remote(nullptr), holder(nullptr)
+                {
+                }
+
+                void Release()
+                {
+                    this->holder.store(nullptr, std::memory_order_relaxed);
+                }
+
+                bool IsHeldByCaller() const
+                {
+                    return this->holder.load(std::memory_order_relaxed) == GetThreadToken();
+                }
+
+                void Push(void* memory, uint32_t height)
+                {
+                    if (this->local.size() <= height)
+                    {
+                        this->local.resize(height + 1, nullptr);
+                    }
+                    Block* block = static_cast<Block*>(memory);
+                    block->next = this->local[height];
+                    this->local[height] = block;
+                }
+
+                void PushRemote(void* memory)
+                {
+                    Block* block = static_cast<Block*>(memory);
+                    Block* head = this->remote.load();
+                    do
+                    {
+                        block->next = head;
+                    }
+                    while (!this->remote.compare_exchange_weak(head, block));
+                }
+
+                // Only the owner pops, and it takes the whole stack at once, so there is no ABA to worry about
+                void DrainRemote()
+                {
+                    Block* block = this->remote.exchange(nullptr);
+                    while (block)
+                    {
+                        Block* next = block->next;
+                        this->Push(block, GetHeader(block)->height);
+                        block = next;
+                    }
+                }
+
+                void* Pop(uint32_t height)
+                {
+                    if (this->local.size() <= height || !this->local[height])
+                    {
+                        return nullptr;
+                    }
+                    Block* block = this->local[height];
+                    this->local[height] = block->next;
+                    return block;
+                }
+
+                void* Carve(std::size_t size, uint32_t height)
+                {
+                    char* memory = static_cast<char*>(AllocateAligned(sizeof(Header) + size));
+                    Header* header = reinterpret_cast<Header*>(memory);
+                    header->owner = this;
+                    header->height = height;
+                    return memory + sizeof(Header);
+                }
+            };
+
+            template<typename N>
+            static Pool* GetPool()
+            {
+                // Outlives every queue, blocks freed during static destruction still need their pools
+                static RecordList<Pool>* pools = new RecordList<Pool>();
+                Pool* pool = pools->Get();
+                pool->holder.store(GetThreadToken(), std::memory_order_relaxed);
+                return pool;
+            }
+
+        public:
+            template<typename N>
+            static void* Allocate(std::size_t size, int level)
+            {
+                Pool* pool = GetPool<N>();
+                void* memory = pool->Pop(level);
+                if (!memory)
+                {
+                    pool->DrainRemote();
+                    memory = pool->Pop(level);
+                }
+                if (!memory)
+                {
+                    memory = pool->Carve(size, level);
+                }
+                return memory;
+            }
+
+            // Goes by the owner of the block alone, never looking up the calling thread's pool: the main thread's
+            // bindings to its pools are gone by the time global queues free their nodes, and the pools with them.
+            template<typename N>
+            static void Free(void* memory)
+            {
+                Header* header = GetHeader(memory);
+                if (header->owner->IsHeldByCaller())
+                {
+                    header->owner->Push(memory, header->height);
+                }
+                else
+                {
+                    header->owner->PushRemote(memory);
+                }
+            }
+
+            template<typename N>
+            static void Reserve(std::size_t size, int level, std::size_t count)
+            {
+                Pool* pool = GetPool<N>();
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    pool->Push(pool->Carve(size, level), level);
+                }
+            }
+    };
+}
+
+#endif // __CSLPQ_ALLOCATOR_HPP__
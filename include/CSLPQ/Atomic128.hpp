@@ -4,8 +4,11 @@
 #include <cstdint>
 #include <utility>
 #include <type_traits>
+#include <emmintrin.h>
 #if defined(_MSC_VER)
 #include <intrin.h>
+#else
+#include <cpuid.h>
 #endif
 
 namespace A128
@@ -24,6 +27,43 @@ namespace A128
     template<class T, class EqualTo = T>
     struct is_equality_comparable : is_equality_comparable_impl<T, EqualTo>::type {};
 
+    // Intel (SDM vol. 3A, 9.1.1) and AMD (APM vol. 1, 3.9.1.3) guarantee that processors enumerating AVX carry out
+    // aligned 16 byte loads with MOVDQA and VMOVDQA atomically. The guarantee is for the processor, so the CPUID bit
+    // alone is enough, the legacy encoding does not need the OS to enable the AVX state. Other vendors make no such
+    // promise and keep using cmpxchg16b. Checked once, the first time it is asked.
+    inline bool HasAtomicVectorLoad()
+    {
+        static const bool has = []()
+        {
+            unsigned int regs[4] = {0, 0, 0, 0};
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            regs[0] = info[0]; regs[1] = info[1]; regs[2] = info[2]; regs[3] = info[3];
+#else
+            if (!__get_cpuid(0, &regs[0], &regs[1], &regs[2], &regs[3]))
+            {
+                return false;
+            }
+#endif
+            // The vendor string is split over ebx, edx, ecx
+            bool intel = regs[1] == 0x756e6547 && regs[3] == 0x49656e69 && regs[2] == 0x6c65746e;
+            bool amd = regs[1] == 0x68747541 && regs[3] == 0x69746e65 && regs[2] == 0x444d4163;
+            if ((!intel && !amd) || regs[0] < 1)
+            {
+                return false;
+            }
+#if defined(_MSC_VER)
+            __cpuid(info, 1);
+            regs[2] = info[2];
+#else
+            __get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+            return ((regs[2] >> 28) & 1) != 0;
+        }();
+        return has;
+    }
+
     template <typename T>
     class Atomic128
     {
@@ -79,7 +119,39 @@ namespace A128
 #endif
             }
 
+            // A plain 16 byte vector load where the processor makes it atomic, cmpxchg16b everywhere else. Stores all
+            // use locked instructions, so these loads are still sequentially consistent with them.
             T Load()
+            {
+                if (!HasAtomicVectorLoad())
+                {
+                    return this->LoadLocked();
+                }
+
+                Data* src_data = (Data*)(&this->value);
+                Data result_data;
+
+#if defined(__clang__) || defined(__GNUC__) || defined(__GNUG__)
+                __m128i result;
+                __asm__ __volatile__
+                (
+                    "movdqa %1, %0"
+                    : "=x" (result)
+                    : "m" (*src_data)
+                    : "memory"
+                );
+                _mm_store_si128(reinterpret_cast<__m128i*>(&result_data), result);
+#elif defined(_MSC_VER)
+                _mm_store_si128(reinterpret_cast<__m128i*>(&result_data),
+                                _mm_load_si128(reinterpret_cast<const __m128i*>(src_data)));
+                _ReadWriteBarrier();
+#endif
+
+                return *(T*)(&result_data);
+            }
+
+            // Always loads with cmpxchg16b, which writes the line and is a full barrier, whatever the processor
+            T LoadLocked()
             {
                 Data* src_data = (Data*)(&this->value);
                 Data result_data = {0, 0};
@@ -110,8 +182,8 @@ namespace A128
                     : "cc"
                 );
 #elif defined(_MSC_VER)
-                _mm_storeu_si128(reinterpret_cast<__m128i*>(&result_data),
-                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_data)));
+                _InterlockedCompareExchange128(reinterpret_cast<int64_t*>(src_data), 0, 0,
+                                               reinterpret_cast<int64_t*>(&result_data));
 #endif
 
                 return *(T*)(&result_data);
@@ -27,6 +27,23 @@ namespace CSLPQ
     template <class T, class EqualTo = T>
     struct is_comparable : is_comparable_impl<T, EqualTo>::type {};
 
+    template <class T, class Compare>
+    struct is_ordered_by_impl
+    {
+        template <class U, class C>
+        static auto test(U*) -> typename std::is_convertible<
+                decltype(std::declval<const C&>()(std::declval<const U&>(), std::declval<const U&>())), bool>::type;
+
+        template <class, class>
+        static auto test(...) -> std::false_type;
+
+        using type = decltype(test<T, Compare>(0));
+    };
+
+    // Whether Compare can order T, as in Compare()(a, b) meaning a goes before b
+    template <class T, class Compare>
+    struct is_ordered_by : is_ordered_by_impl<T, Compare>::type {};
+
     template <class T>
     struct is_printable_impl
     {
@@ -0,0 +1,183 @@
+#ifndef __CSLPQ_COUNT_HPP__
+#define __CSLPQ_COUNT_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+#include "Allocator.hpp"
+
+namespace CSLPQ
+{
+    // Counting policies, keeping the number of keys GetSize reports. Every push adds to the count and every pop
+    // subtracts from it, so the policy decides what the hot path pays for that statistic:
+    //  - Add/Sub(n): called once per push or pop, or once per batch.
+    //  - TryAddBelow(limit): adds one unless the count has reached limit, for bounded queues. Only exact counters
+    //    can tell, a queue refuses a bound with any other, so theirs is never called.
+    //  - Get: the current count.
+    //  - exact: whether Get and TryAddBelow see every change the moment it is made.
+
+    // One 64 bit atomic counter. Exact, but every push and pop does an atomic add on the same cache line.
+    class ExactCount
+    {
+        private:
+            std::atomic<uint64_t> count;
+
+        public:
+            static const bool exact = true;
+
+            ExactCount() : count(0)
+            {
+            }
+
+            ExactCount(ExactCount&& other) noexcept : count(other.count.exchange(0))
+            {
+            }
+
+            void Add(uint64_t n)
+            {
+                this->count.fetch_add(n);
+            }
+
+            void Sub(uint64_t n)
+            {
+                this->count.fetch_sub(n);
+            }
+
+            bool TryAddBelow(uint64_t limit)
+            {
+                uint64_t current = this->count.load();
+                do
+                {
+                    if (current >= limit)
+                    {
+                        return false;
+                    }
+                }
+                while (!this->count.compare_exchange_weak(current, current + 1));
+                return true;
+            }
+
+            uint64_t Get() const
+            {
+                return this->count.load();
+            }
+    };
+
+    // Stripes counters on their own cache lines, threads are dealt out over them in the order they first count, so
+    // up to Stripes threads each keep to their own line. A key pushed on one stripe and popped on another leaves one
+    // up and the other down, Get sums them, which is exact once the queue is quiet and may be off by the operations
+    // in flight while it is not.
+    template<uint32_t Stripes = 16>
+    class ShardedCount
+    {
+        static_assert(Stripes > 0, "Stripes must be positive");
+        private:
+            struct Stripe
+            {
+                std::atomic<int64_t> count;
+                char padding[cache_line_size - sizeof(std::atomic<int64_t>)];
+            };
+
+            // One line more than the stripes need, so they can start on a line boundary wherever the queue lives.
+            // alignas would do the same, but C++11 does not honour it for queues allocated with new.
+            char storage[(Stripes + 1) * cache_line_size];
+            Stripe* const stripes;
+
+            Stripe* AlignStripes()
+            {
+                std::uintptr_t address = reinterpret_cast<std::uintptr_t>(this->storage);
+                address = (address + cache_line_size - 1) & ~std::uintptr_t(cache_line_size - 1);
+                Stripe* stripes = reinterpret_cast<Stripe*>(address);
+                for (uint32_t i = 0; i < Stripes; ++i)
+                {
+                    new (&stripes[i].count) std::atomic<int64_t>(0);
+                }
+                return stripes;
+            }
+
+            static uint32_t GetStripe()
+            {
+                static std::atomic<uint32_t> next(0);
+                thread_local uint32_t stripe = next.fetch_add(1) % Stripes;
+                return stripe;
+            }
+
+        public:
+            static const bool exact = false;
+
+            ShardedCount() : stripes(this->AlignStripes())
+            {
+            }
+
+            ShardedCount(ShardedCount&& other) noexcept : stripes(this->AlignStripes())
+            {
+                for (uint32_t i = 0; i < Stripes; ++i)
+                {
+                    this->stripes[i].count.store(other.stripes[i].count.exchange(0));
+                }
+            }
+
+            void Add(uint64_t n)
+            {
+                this->stripes[GetStripe()].count.fetch_add(n, std::memory_order_relaxed);
+            }
+
+            void Sub(uint64_t n)
+            {
+                this->stripes[GetStripe()].count.fetch_sub(n, std::memory_order_relaxed);
+            }
+
+            bool TryAddBelow(uint64_t)
+            {
+                this->Add(1);
+                return true;
+            }
+
+            uint64_t Get() const
+            {
+                int64_t count = 0;
+                for (uint32_t i = 0; i < Stripes; ++i)
+                {
+                    count += this->stripes[i].count.load(std::memory_order_relaxed);
+                }
+                // Pops counted before the pushes they took can make the sum dip below zero
+                return count > 0 ? count : 0;
+            }
+    };
+
+    // Counts nothing, for queues whose size nobody asks for. Get is always 0.
+    class NoCount
+    {
+        public:
+            static const bool exact = false;
+
+            NoCount()
+            {
+            }
+
+            NoCount(NoCount&&) noexcept
+            {
+            }
+
+            void Add(uint64_t)
+            {
+            }
+
+            void Sub(uint64_t)
+            {
+            }
+
+            bool TryAddBelow(uint64_t)
+            {
+                return true;
+            }
+
+            uint64_t Get() const
+            {
+                return 0;
+            }
+    };
+}
+
+#endif // __CSLPQ_COUNT_HPP__
@@ -0,0 +1,195 @@
+#ifndef __CSLPQ_EPOCH_HPP__
+#define __CSLPQ_EPOCH_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Reclamation.hpp"
+
+namespace CSLPQ
+{
+    // Epoch based reclamation. Nodes are referenced through raw pointers and links are plain 8 byte words, so a
+    // traversal never writes to the nodes it reads. Every operation announces the global epoch it started in, a node
+    // unlinked from every level is put aside tagged with the epoch it was retired in, and freed once the global epoch
+    // moved two steps past it, at which point no operation that could have seen it is still running.
+    // The catch is that a thread stalled inside an operation holds the epoch back, and with it every retired node.
+    class EpochReclamation
+    {
+        public:
+            template<typename N>
+            using Pointer = N*;
+
+            template<typename N>
+            using Link = MarkablePointer<N>;
+
+            struct Parameters
+            {
+                // Nodes a thread retires before it tries to advance the epoch and free what it has put aside
+                uint32_t retire_batch;
+
+                Parameters(uint32_t retire_batch = 64) : retire_batch(retire_batch)
+                {
+                }
+            };
+
+        private:
+            struct Record : public ThreadRecord
+            {
+                // Announced epoch shifted left by one, the lowest bit is set while inside an operation
+                std::atomic<uint64_t> epoch;
+                uint32_t depth;
+                uint32_t retired_since_collect;
+                std::vector<Retired> retired;
+
+                Record() : epoch(0), depth(0), retired_since_collect(0)
+                {
+                }
+
+                void Release()
+                {
+                    this->depth = 0;
+                    this->epoch.store(this->epoch.load() & ~uint64_t(1));
+                }
+            };
+
+            Parameters parameters;
+            std::atomic<uint64_t> epoch;
+            RecordList<Record> records;
+
+            void Enter(Record* record)
+            {
+                if (record->depth++ == 0)
+                {
+                    record->epoch.store((this->epoch.load() << 1) | 1);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                }
+            }
+
+            void Exit(Record* record)
+            {
+                if (--record->depth == 0)
+                {
+                    record->epoch.store(record->epoch.load(std::memory_order_relaxed) & ~uint64_t(1),
+                                        std::memory_order_release);
+                }
+            }
+
+            bool TryAdvance()
+            {
+                uint64_t current = this->epoch.load();
+                for (Record* record = this->records.GetHead(); record; record = static_cast<Record*>(record->next))
+                {
+                    uint64_t announced = record->epoch.load();
+                    if ((announced & 1) && (announced >> 1) != current)
+                    {
+                        return false;
+                    }
+                }
+                return this->epoch.compare_exchange_strong(current, current + 1);
+            }
+
+            void Collect(Record* record)
+            {
+                record->retired_since_collect = 0;
+                this->TryAdvance();
+                uint64_t safe = this->epoch.load();
+                // Retired nodes are appended in epoch order, so the freeable ones form a prefix
+                std::vector<Retired>::iterator it = record->retired.begin();
+                while (it != record->retired.end() && it->epoch + 2 <= safe)
+                {
+                    it->Free();
+                    ++it;
+                }
+                record->retired.erase(record->retired.begin(), it);
+            }
+
+            void Retire(Record* record, void* node, void (*deleter)(void*))
+            {
+                record->retired.emplace_back(node, deleter, this->epoch.load());
+                if (++record->retired_since_collect >= this->parameters.retire_batch)
+                {
+                    this->Collect(record);
+                }
+            }
+
+        public:
+            class Guard
+            {
+                private:
+                    EpochReclamation& domain;
+                    Record* record;
+
+                public:
+                    explicit Guard(EpochReclamation& domain) : domain(domain), record(domain.records.Get())
+                    {
+                        this->domain.Enter(this->record);
+                    }
+
+                    ~Guard()
+                    {
+                        this->domain.Exit(this->record);
+                    }
+
+                    Guard(const Guard&) = delete;
+                    Guard& operator=(const Guard&) = delete;
+
+                    template<typename N>
+                    std::pair<N*, bool> Protect(uint32_t, N* node, int level)
+                    {
+                        return node->GetNextPointerAndMark(level);
+                    }
+
+                    template<typename N>
+                    void Publish(uint32_t, N*)
+                    {
+                    }
+
+                    template<typename N>
+                    void Retire(N* node)
+                    {
+                        this->domain.Retire(this->record, node, &DeleteNode<N>);
+                    }
+            };
+
+            EpochReclamation(uint32_t, const Parameters& parameters = Parameters()) : parameters(parameters), epoch(0)
+            {
+            }
+
+            EpochReclamation(const EpochReclamation&) = delete;
+
+            EpochReclamation(EpochReclamation&& other) noexcept : parameters(other.parameters),
+                    epoch(other.epoch.load()), records(std::move(other.records))
+            {
+            }
+
+            EpochReclamation& operator=(const EpochReclamation&) = delete;
+
+            ~EpochReclamation()
+            {
+                for (Record* record = this->records.GetHead(); record; record = static_cast<Record*>(record->next))
+                {
+                    for (const Retired& retired : record->retired)
+                    {
+                        retired.Free();
+                    }
+                    record->retired.clear();
+                }
+            }
+
+            template<typename N, typename... Args>
+            static N* Create(int level, Args&&... args)
+            {
+                return new (level) N(std::forward<Args>(args)..., level);
+            }
+
+            template<typename N>
+            static void Destroy(N* head, uint32_t max_level)
+            {
+                DestroyNodes(head, max_level);
+            }
+    };
+}
+
+#endif // __CSLPQ_EPOCH_HPP__
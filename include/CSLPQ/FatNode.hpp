@@ -0,0 +1,535 @@
+#ifndef __CSLPQ_FAT_NODE_HPP__
+#define __CSLPQ_FAT_NODE_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define CSLPQ_VECTOR_SEARCH 1
+#endif
+
+#include "Atomic128.hpp"
+#include "Reclamation.hpp"
+#include "Allocator.hpp"
+#include "Node.hpp"
+
+namespace CSLPQ
+{
+    // An immutable sorted run of keys, what one node of an UnrolledQueue holds. A push never changes a block, it
+    // swaps in a new one, so keys can be read out of a block without any synchronization. Blocks come from the
+    // allocator policy in power of two capacities, and are 16 byte aligned like every block the policies hand out,
+    // leaving the 4 lowest address bits to the node for its pop count.
+    template<typename K, typename A>
+    class alignas(16) KeyBlock
+    {
+        private:
+            uint32_t count;
+
+            explicit KeyBlock(uint32_t count) : count(count)
+            {
+            }
+
+            static std::size_t GetKeysOffset()
+            {
+                return (sizeof(KeyBlock) + alignof(K) - 1) / alignof(K) * alignof(K);
+            }
+
+            static uint32_t GetSizeClass(uint32_t count)
+            {
+                uint32_t size_class = 0;
+                while ((1u << size_class) < count)
+                {
+                    ++size_class;
+                }
+                return size_class;
+            }
+
+        public:
+            KeyBlock(const KeyBlock&) = delete;
+            KeyBlock& operator=(const KeyBlock&) = delete;
+
+            static KeyBlock* Create(const K* keys, uint32_t count)
+            {
+                uint32_t size_class = GetSizeClass(count);
+                void* memory = A::template Allocate<KeyBlock>(GetKeysOffset() + (std::size_t(1) << size_class) *
+                                                              sizeof(K), size_class);
+                KeyBlock* block = new (memory) KeyBlock(count);
+                std::copy(keys, keys + count, block->GetKeys());
+                return block;
+            }
+
+            static void operator delete(void* memory)
+            {
+                A::template Free<KeyBlock>(memory);
+            }
+
+            uint32_t GetCount() const
+            {
+                return this->count;
+            }
+
+            const K* GetKeys() const
+            {
+                return reinterpret_cast<const K*>(reinterpret_cast<const char*>(this) + GetKeysOffset());
+            }
+
+            K* GetKeys()
+            {
+                return reinterpret_cast<K*>(reinterpret_cast<char*>(this) + GetKeysOffset());
+            }
+    };
+
+    // A skiplist node of an UnrolledQueue. Its key is the lowest key it is meant to hold, the node holds a block of
+    // the keys from there up to the key of the next node, and the head holds those below the first node. Above level 0
+    // it is linked like any node, through a tower of R::Link. Level 0 is a 16 byte word instead: the successor with
+    // the deletion mark in its lowest bit, and the block with the number of keys already popped from it in its 4
+    // lowest bits. Popping keys, pushing one into the block, and splitting the block into a new node right behind this
+    // one are then all a single CAS on that word, and cannot miss each other.
+    //
+    // The level 0 word is a raw pointer, so only the pointer based reclamation policies can link these nodes.
+    template<typename K, typename R, typename A>
+    class FatNode : public PrefixField<NoPrefix>
+    {
+        public:
+            typedef K Key;
+            typedef NoPrefix Prefix;
+            typedef typename R::template Pointer<FatNode<K, R, A>> SPtr;
+            typedef typename R::template Link<FatNode<K, R, A>> MASPtr;
+            typedef KeyBlock<K, A> Block;
+
+            // Low bits of the block address that count the popped keys
+            static const uint32_t taken_mask = 15;
+
+            struct alignas(16) State
+            {
+                uintptr_t next;
+                uintptr_t block;
+
+                State() : next(0), block(0)
+                {
+                }
+
+                State(SPtr next, bool marked, Block* block, uint32_t taken) :
+                      next(reinterpret_cast<uintptr_t>(next) | marked),
+                      block(block ? reinterpret_cast<uintptr_t>(block) | taken : 0)
+                {
+                }
+
+                SPtr GetNext() const
+                {
+                    return reinterpret_cast<SPtr>(this->next & ~uintptr_t(1));
+                }
+
+                bool IsMarked() const
+                {
+                    return this->next & 1;
+                }
+
+                Block* GetBlock() const
+                {
+                    return reinterpret_cast<Block*>(this->block & ~uintptr_t(taken_mask));
+                }
+
+                uint32_t GetTaken() const
+                {
+                    return this->block & taken_mask;
+                }
+
+                // Keys in the block not popped yet. A block is swapped out with its last key, so a node with a block
+                // always has some left.
+                uint32_t GetRemaining() const
+                {
+                    Block* block = this->GetBlock();
+                    return block ? block->GetCount() - this->GetTaken() : 0;
+                }
+
+                bool operator==(const State& other) const
+                {
+                    return this->next == other.next && this->block == other.block;
+                }
+
+                bool operator!=(const State& other) const
+                {
+                    return !(*this == other);
+                }
+            };
+
+        private:
+            K priority;
+            int level;
+            std::atomic<bool> inserting;
+            std::atomic<int> links;
+            mutable A128::Atomic128<State> bottom;
+
+            // Links of levels 1 and up, level 0 lives in bottom
+            MASPtr* GetTower() const
+            {
+                return reinterpret_cast<MASPtr*>(reinterpret_cast<char*>(const_cast<FatNode*>(this)) +
+                                                 TowerOffset<FatNode, MASPtr>());
+            }
+
+            void BuildTower()
+            {
+                for (int level = 1; level < this->level; ++level)
+                {
+                    new (&this->GetTower()[level - 1]) MASPtr();
+                }
+            }
+
+        public:
+            FatNode(const K& priority, int level) : PrefixField<NoPrefix>(priority), priority(priority), level(level),
+                    inserting(true), links(level)
+            {
+                this->BuildTower();
+            }
+
+            // Nothing can be reading the node anymore, and its block went with it
+            ~FatNode()
+            {
+                delete this->bottom.Load().GetBlock();
+                for (int level = 1; level < this->level; ++level)
+                {
+                    this->GetTower()[level - 1].~MASPtr();
+                }
+            }
+
+            FatNode(const FatNode&) = delete;
+            FatNode& operator=(const FatNode&) = delete;
+
+            static std::size_t GetBlockSize(int level)
+            {
+                return TowerOffset<FatNode, MASPtr>() + (level - 1) * sizeof(MASPtr);
+            }
+
+            // Lets the calling thread create count nodes of the given level without going to the system allocator
+            static void Reserve(int level, std::size_t count)
+            {
+                A::template Reserve<FatNode>(GetBlockSize(level), level, count);
+            }
+
+            static void* operator new(std::size_t, int level)
+            {
+                return A::template Allocate<FatNode>(GetBlockSize(level), level);
+            }
+
+            static void operator delete(void* memory, int)
+            {
+                A::template Free<FatNode>(memory);
+            }
+
+            static void operator delete(void* memory)
+            {
+                A::template Free<FatNode>(memory);
+            }
+
+            State LoadState() const
+            {
+                return this->bottom.Load();
+            }
+
+            // On failure expected is refreshed with the current state
+            bool CompareExchangeState(State& expected, const State& desired)
+            {
+                return this->bottom.CompareExchange(expected, desired);
+            }
+
+            // Only for nodes nobody else can see yet
+            void SetState(const State& state)
+            {
+                State current = this->bottom.Load();
+                while (!this->bottom.CompareExchange(current, state))
+                {
+                }
+            }
+
+            SPtr GetNextPointer(int level) const
+            {
+                if (!level)
+                {
+                    return this->bottom.Load().GetNext();
+                }
+                return this->GetTower()[level - 1].load();
+            }
+
+            bool IsNextMarked(int level) const
+            {
+                if (!level)
+                {
+                    return this->bottom.Load().IsMarked();
+                }
+                return this->GetTower()[level - 1].is_marked();
+            }
+
+            std::pair<SPtr, bool> GetNextPointerAndMark(int level) const
+            {
+                if (!level)
+                {
+                    State state = this->bottom.Load();
+                    return std::make_pair(state.GetNext(), state.IsMarked());
+                }
+                return this->GetTower()[level - 1].load_marked();
+            }
+
+            int GetLevel() const
+            {
+                return this->level;
+            }
+
+            KeyReference<K> GetPriority() const
+            {
+                return this->priority;
+            }
+
+            bool IsInserting() const
+            {
+                return this->inserting.load();
+            }
+
+            void SetNext(int level, SPtr node)
+            {
+                if (!level)
+                {
+                    State state = this->bottom.Load();
+                    this->SetState(State(node, false, state.GetBlock(), state.GetTaken()));
+                    return;
+                }
+                this->GetTower()[level - 1] = node;
+            }
+
+            void SetNextMark(int level)
+            {
+                if (!level)
+                {
+                    State state = this->bottom.Load();
+                    State marked = state;
+                    marked.next |= 1;
+                    while (!state.IsMarked() && !this->bottom.CompareExchange(state, marked))
+                    {
+                        marked = state;
+                        marked.next |= 1;
+                    }
+                    return;
+                }
+                this->GetTower()[level - 1].set_mark();
+            }
+
+            // Same contract as MarkablePointer::test_and_set_mark, a popped key or a new block in between does not
+            // make it fail
+            bool TestAndSetMark(int level, SPtr& expected)
+            {
+                if (!level)
+                {
+                    State state = this->bottom.Load();
+                    while (!state.IsMarked())
+                    {
+                        State marked = state;
+                        marked.next |= 1;
+                        if (this->bottom.CompareExchange(state, marked))
+                        {
+                            return true;
+                        }
+                    }
+                    expected = state.GetNext();
+                    return false;
+                }
+                return this->GetTower()[level - 1].test_and_set_mark(expected);
+            }
+
+            // Same contract as MarkablePointer::compare_exchange_weak, the block is carried over as it is
+            bool CompareExchange(int level, SPtr& old_value, SPtr new_value)
+            {
+                if (!level)
+                {
+                    State state = this->bottom.Load();
+                    while (state.next == reinterpret_cast<uintptr_t>(old_value))
+                    {
+                        State desired = state;
+                        desired.next = reinterpret_cast<uintptr_t>(new_value);
+                        if (this->bottom.CompareExchange(state, desired))
+                        {
+                            return true;
+                        }
+                    }
+                    old_value = state.GetNext();
+                    return false;
+                }
+                return this->GetTower()[level - 1].compare_exchange_weak(old_value, new_value);
+            }
+
+            void SetDoneInserting()
+            {
+                this->inserting.store(false);
+            }
+
+            // Called once for every level the node gets unlinked from, returns true when that was the last one.
+            bool ReleaseLink()
+            {
+                return this->links.fetch_sub(1) == 1;
+            }
+    };
+
+#ifdef CSLPQ_VECTOR_SEARCH
+    // Whether the CPU has AVX2 and the OS saves the full vector registers, checked once
+    inline bool HasAVX2()
+    {
+        static const bool has = []()
+        {
+            unsigned int eax = 0;
+            unsigned int ebx = 0;
+            unsigned int ecx = 0;
+            unsigned int edx = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+            {
+                return false;
+            }
+            uint32_t xcr0 = 0;
+            uint32_t xcr0_high = 0;
+            __asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0_high) : "c" (0));
+            if ((xcr0 & 6) != 6 || __get_cpuid_max(0, nullptr) < 7)
+            {
+                return false;
+            }
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            return (ebx & bit_AVX2) != 0;
+        }();
+        return has;
+    }
+
+    // Index of the first of the sorted keys that comes after bound, four at a time, stopping short of the last
+    // count % 4 keys. flip maps unsigned keys onto the signed order the compare instruction knows.
+    template<bool Descending>
+    __attribute__((target("avx2"))) inline uint32_t SkipNotAfterAVX2(const int64_t* keys, uint32_t count,
+                                                                       int64_t bound, int64_t flip)
+    {
+        const __m256i bias = _mm256_set1_epi64x(flip);
+        const __m256i limit = _mm256_xor_si256(_mm256_set1_epi64x(bound), bias);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256i chunk = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+            __m256i after = Descending ? _mm256_cmpgt_epi64(limit, chunk) : _mm256_cmpgt_epi64(chunk, limit);
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(after));
+            if (mask)
+            {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return i;
+    }
+
+    template<bool Descending>
+    __attribute__((target("avx2"))) inline uint32_t SkipNotAfterAVX2(const double* keys, uint32_t count,
+                                                                       double bound)
+    {
+        const __m256d limit = _mm256_set1_pd(bound);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d chunk = _mm256_loadu_pd(keys + i);
+            __m256d after = Descending ? _mm256_cmp_pd(chunk, limit, _CMP_LT_OQ) :
+                                         _mm256_cmp_pd(chunk, limit, _CMP_GT_OQ);
+            int mask = _mm256_movemask_pd(after);
+            if (mask)
+            {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return i;
+    }
+
+    template<bool Descending>
+    inline uint32_t SkipNotAfter(const uint64_t* keys, uint32_t count, uint64_t bound)
+    {
+        return SkipNotAfterAVX2<Descending>(reinterpret_cast<const int64_t*>(keys), count, int64_t(bound),
+                                            INT64_MIN);
+    }
+
+    template<bool Descending>
+    inline uint32_t SkipNotAfter(const int64_t* keys, uint32_t count, int64_t bound)
+    {
+        return SkipNotAfterAVX2<Descending>(keys, count, bound, 0);
+    }
+
+    template<bool Descending>
+    inline uint32_t SkipNotAfter(const double* keys, uint32_t count, double bound)
+    {
+        return SkipNotAfterAVX2<Descending>(keys, count, bound);
+    }
+#endif
+
+    // Which keys and orders the vector search knows: 1 for std::less, 2 for std::greater on 64 bit integers and doubles
+    template<typename K, typename Compare>
+    struct VectorOrder
+    {
+        static const int value = 0;
+    };
+
+#ifdef CSLPQ_VECTOR_SEARCH
+    template<typename K>
+    struct VectorOrder<K, std::less<K>>
+    {
+        static const int value = std::is_same<K, uint64_t>::value || std::is_same<K, int64_t>::value ||
+                                 std::is_same<K, double>::value ? 1 : 0;
+    };
+
+    template<typename K>
+    struct VectorOrder<K, std::greater<K>>
+    {
+        static const int value = std::is_same<K, uint64_t>::value || std::is_same<K, int64_t>::value ||
+                                 std::is_same<K, double>::value ? 2 : 0;
+    };
+#endif
+
+    template<typename K, typename Compare, int Order = VectorOrder<K, Compare>::value>
+    struct BlockSearch
+    {
+        static uint32_t Skip(const K*, uint32_t, const K&)
+        {
+            return 0;
+        }
+    };
+
+#ifdef CSLPQ_VECTOR_SEARCH
+    template<typename K, typename Compare, int Order>
+    struct BlockSearchVector
+    {
+        static uint32_t Skip(const K* keys, uint32_t count, const K& bound)
+        {
+            return HasAVX2() ? SkipNotAfter<Order == 2>(keys, count, bound) : 0;
+        }
+    };
+
+    template<typename K, typename Compare>
+    struct BlockSearch<K, Compare, 1> : BlockSearchVector<K, Compare, 1>
+    {
+    };
+
+    template<typename K, typename Compare>
+    struct BlockSearch<K, Compare, 2> : BlockSearchVector<K, Compare, 2>
+    {
+    };
+#endif
+
+    // Number of the sorted keys[0 .. count) that do not come after bound, which is where bound would go after its
+    // equals. 64 bit integer and double keys under std::less or std::greater are compared four at a time with AVX2
+    // when the CPU has it, the rest of the keys one at a time with less, which orders them as Compare does.
+    template<typename Compare, typename K, typename Less>
+    uint32_t CountNotAfter(const K* keys, uint32_t count, const K& bound, const Less& less)
+    {
+        uint32_t i = BlockSearch<K, Compare>::Skip(keys, count, bound);
+        while (i < count && !less(bound, keys[i]))
+        {
+            ++i;
+        }
+        return i;
+    }
+}
+
+#endif // __CSLPQ_FAT_NODE_HPP__
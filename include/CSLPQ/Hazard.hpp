@@ -0,0 +1,234 @@
+#ifndef __CSLPQ_HAZARD_HPP__
+#define __CSLPQ_HAZARD_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Reclamation.hpp"
+
+namespace CSLPQ
+{
+    // Hazard pointer based reclamation. Links are plain 8 byte words like with epochs, but instead of announcing an
+    // epoch, a thread publishes every node it is about to dereference in one of its hazard slots. A retired node is
+    // freed as soon as no slot of any thread holds it, so a stalled thread only pins the handful of nodes it has
+    // published.
+    //
+    // Each thread keeps at most max(retire_threshold, H + 1) retired nodes, H being the total number of hazard slots
+    // of all threads (threads * (4 + 2 * (max_level + 1))). Once its list reaches retire_threshold, every further
+    // retire scans the slots and frees up to scan_batch unprotected nodes, and at most H of them can be protected.
+    //
+    // The price over epochs is a full fence per node visited, since a slot has to be visible before the link it was
+    // read from is checked again.
+    class HazardReclamation
+    {
+        public:
+            template<typename N>
+            using Pointer = N*;
+
+            template<typename N>
+            using Link = MarkablePointer<N>;
+
+            struct Parameters
+            {
+                // Retired nodes a thread keeps before it starts scanning the hazard slots on every retire
+                uint32_t retire_threshold;
+                // Nodes freed by a single scan at most, bounding the work added to any one operation. 0 frees all
+                // that can be freed.
+                uint32_t scan_batch;
+
+                Parameters(uint32_t retire_threshold = 128, uint32_t scan_batch = 64) :
+                           retire_threshold(retire_threshold), scan_batch(scan_batch)
+                {
+                }
+            };
+
+        private:
+            struct Record : public ThreadRecord
+            {
+                const uint32_t slots;
+                std::unique_ptr<std::atomic<void*>[]> hazards;
+                uint32_t depth;
+                std::vector<Retired> retired;
+                std::vector<void*> scratch;
+
+                explicit Record(uint32_t slots) : slots(slots), hazards(new std::atomic<void*>[slots]), depth(0)
+                {
+                    this->Clear();
+                }
+
+                void Clear()
+                {
+                    for (uint32_t slot = 0; slot < this->slots; ++slot)
+                    {
+                        this->hazards[slot].store(nullptr, std::memory_order_release);
+                    }
+                }
+
+                void Release()
+                {
+                    this->depth = 0;
+                    this->Clear();
+                }
+            };
+
+            const uint32_t slots;
+            Parameters parameters;
+            RecordList<Record> records;
+
+            void Scan(Record* record)
+            {
+                // Slots are read in increasing order. Publish only ever copies a node to a higher slot than the one
+                // protecting it, so a node moving between slots while we scan is seen in at least one of them.
+                std::vector<void*>& hazards = record->scratch;
+                hazards.clear();
+                for (Record* other = this->records.GetHead(); other; other = static_cast<Record*>(other->next))
+                {
+                    for (uint32_t slot = 0; slot < other->slots; ++slot)
+                    {
+                        void* hazard = other->hazards[slot].load();
+                        if (hazard)
+                        {
+                            hazards.push_back(hazard);
+                        }
+                    }
+                }
+                std::sort(hazards.begin(), hazards.end());
+
+                uint32_t freed = 0;
+                std::vector<Retired>::iterator keep = record->retired.begin();
+                for (std::vector<Retired>::iterator it = record->retired.begin(); it != record->retired.end(); ++it)
+                {
+                    if ((!this->parameters.scan_batch || freed < this->parameters.scan_batch) &&
+                        !std::binary_search(hazards.begin(), hazards.end(), it->pointer))
+                    {
+                        it->Free();
+                        ++freed;
+                    }
+                    else
+                    {
+                        *keep = *it;
+                        ++keep;
+                    }
+                }
+                record->retired.erase(keep, record->retired.end());
+            }
+
+            void Retire(Record* record, void* node, void (*deleter)(void*))
+            {
+                record->retired.emplace_back(node, deleter);
+                if (record->retired.size() >= this->parameters.retire_threshold)
+                {
+                    this->Scan(record);
+                }
+            }
+
+        public:
+            class Guard
+            {
+                private:
+                    HazardReclamation& domain;
+                    Record* record;
+
+                public:
+                    explicit Guard(HazardReclamation& domain) : domain(domain),
+                                   record(domain.records.Get(domain.slots))
+                    {
+                        this->record->depth++;
+                    }
+
+                    ~Guard()
+                    {
+                        if (--this->record->depth == 0)
+                        {
+                            this->record->Clear();
+                        }
+                    }
+
+                    Guard(const Guard&) = delete;
+                    Guard& operator=(const Guard&) = delete;
+
+                    // Reads the next pointer of node at level and publishes it in slot. The link is read again after
+                    // publishing, if it still holds the same value the target cannot have been retired in between.
+                    template<typename N>
+                    std::pair<N*, bool> Protect(uint32_t slot, N* node, int level)
+                    {
+                        std::pair<N*, bool> next = node->GetNextPointerAndMark(level);
+                        while (true)
+                        {
+                            this->record->hazards[slot].store(next.first);
+                            std::pair<N*, bool> check = node->GetNextPointerAndMark(level);
+                            if (check == next)
+                            {
+                                return next;
+                            }
+                            next = check;
+                        }
+                    }
+
+                    // Copies a node that is already protected by a lower slot into slot. Copying to a lower slot is
+                    // only safe if the caller then checks one of the node's links is still unmarked, as Protect does.
+                    template<typename N>
+                    void Publish(uint32_t slot, N* node)
+                    {
+                        this->record->hazards[slot].store(node);
+                    }
+
+                    template<typename N>
+                    void Retire(N* node)
+                    {
+                        this->domain.Retire(this->record, node, &DeleteNode<N>);
+                    }
+            };
+
+            HazardReclamation(uint32_t slots, const Parameters& parameters = Parameters()) : slots(slots),
+                              parameters(parameters)
+            {
+            }
+
+            HazardReclamation(const HazardReclamation&) = delete;
+
+            HazardReclamation(HazardReclamation&& other) noexcept : slots(other.slots), parameters(other.parameters),
+                              records(std::move(other.records))
+            {
+            }
+
+            HazardReclamation& operator=(const HazardReclamation&) = delete;
+
+            ~HazardReclamation()
+            {
+                for (Record* record = this->records.GetHead(); record; record = static_cast<Record*>(record->next))
+                {
+                    for (const Retired& retired : record->retired)
+                    {
+                        retired.Free();
+                    }
+                    record->retired.clear();
+                }
+            }
+
+            // Nodes the calling thread has retired that are not freed yet
+            std::size_t GetRetiredCount()
+            {
+                return this->records.Get(this->slots)->retired.size();
+            }
+
+            template<typename N, typename... Args>
+            static N* Create(int level, Args&&... args)
+            {
+                return new (level) N(std::forward<Args>(args)..., level);
+            }
+
+            template<typename N>
+            static void Destroy(N* head, uint32_t max_level)
+            {
+                DestroyNodes(head, max_level);
+            }
+    };
+}
+
+#endif // __CSLPQ_HAZARD_HPP__
@@ -0,0 +1,114 @@
+#ifndef __CSLPQ_MARKABLE_POINTER_HPP__
+#define __CSLPQ_MARKABLE_POINTER_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+
+namespace CSLPQ
+{
+    // A raw pointer with a deletion mark packed into its lowest (alignment) bit. It mirrors the interface of
+    // jss::markable_atomic_shared_ptr so nodes can use either one as their next pointers, but every operation is a
+    // single 8 byte atomic and loads are plain loads. Lifetime of the pointee is left to the reclamation scheme.
+    template<typename T>
+    class MarkablePointer
+    {
+        static_assert(std::alignment_of<T>::value >= 2, "Pointee must leave the lowest address bit free");
+        private:
+            static const uintptr_t mark_bit = 1;
+
+            std::atomic<uintptr_t> value;
+
+            static T* GetPointer(uintptr_t value)
+            {
+                return reinterpret_cast<T*>(value & ~mark_bit);
+            }
+
+        public:
+            MarkablePointer() noexcept : value(0)
+            {
+            }
+
+            MarkablePointer(T* ptr) noexcept : value(reinterpret_cast<uintptr_t>(ptr))
+            {
+            }
+
+            MarkablePointer(const MarkablePointer&) = delete;
+            MarkablePointer& operator=(const MarkablePointer&) = delete;
+
+            bool is_lock_free() const noexcept
+            {
+                return this->value.is_lock_free();
+            }
+
+            void store(T* ptr) noexcept
+            {
+                this->value.store(reinterpret_cast<uintptr_t>(ptr));
+            }
+
+            T* load() const noexcept
+            {
+                return GetPointer(this->value.load());
+            }
+
+            operator T*() const noexcept
+            {
+                return this->load();
+            }
+
+            bool is_marked() const noexcept
+            {
+                return this->value.load() & mark_bit;
+            }
+
+            std::pair<T*, bool> load_marked() const noexcept
+            {
+                uintptr_t current = this->value.load();
+                return std::make_pair(GetPointer(current), (current & mark_bit) != 0);
+            }
+
+            void set_mark() noexcept
+            {
+                this->value.fetch_or(mark_bit);
+            }
+
+            // Same contract as the shared version: marks the pointer only if it was unmarked and unchanged between
+            // the load and the CAS, on failure expected is refreshed with the current pointer.
+            bool test_and_set_mark(T*& expected) noexcept
+            {
+                uintptr_t current = this->value.load();
+                if (!(current & mark_bit) && this->value.compare_exchange_strong(current, current | mark_bit))
+                {
+                    return true;
+                }
+                expected = GetPointer(current);
+                return false;
+            }
+
+            // Fails if the pointer is marked, on failure expected is refreshed with the current pointer.
+            bool compare_exchange_weak(T*& expected, T* desired) noexcept
+            {
+                uintptr_t current = reinterpret_cast<uintptr_t>(expected);
+                if (this->value.compare_exchange_strong(current, reinterpret_cast<uintptr_t>(desired)))
+                {
+                    return true;
+                }
+                expected = GetPointer(current);
+                return false;
+            }
+
+            bool compare_exchange_strong(T*& expected, T* desired) noexcept
+            {
+                return this->compare_exchange_weak(expected, desired);
+            }
+
+            T* operator=(T* ptr) noexcept
+            {
+                this->store(ptr);
+                return ptr;
+            }
+    };
+}
+
+#endif // __CSLPQ_MARKABLE_POINTER_HPP__
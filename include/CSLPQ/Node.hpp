@@ -1,46 +1,124 @@
 #ifndef __CSLPQ_NODE_HPP__
 #define __CSLPQ_NODE_HPP__
 
-#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "Concepts.hpp"
-#include "Pointers.hpp"
+#include "Prefix.hpp"
+#include "Reclamation.hpp"
+#include "Allocator.hpp"
 
 namespace CSLPQ
 {
+    // Nodes live in a single block from the allocator policy A: the node fields followed by a tower of next links
+    // sized to its level. A level-0 step then reads the key and the link from the same cache line. Blocks are sized
+    // at construction, so nodes must be created through new (level) N(..., level), which every reclamation policy's
+    // Create does.
+    // Where the tower starts within the block of node type N
+    template<typename N, typename Link>
+    constexpr std::size_t TowerOffset()
+    {
+        return (sizeof(N) + alignof(Link) - 1) / alignof(Link) * alignof(Link);
+    }
+
+    // What nodes hand out their key as. Arithmetic keys are returned by value, in a register, anything else by
+    // reference into the node, so a search does not copy a pair or a string at every node it passes.
     template<typename K>
-    class Node
+    using KeyReference = typename std::conditional<std::is_arithmetic<K>::value, K, const K&>::type;
+
+    // P is the prefix policy, see Prefix.hpp, the prefix of the key is kept in front of it
+    template<typename K, typename R = SharedReclamation, typename A = DefaultAllocator, typename P = NoPrefix>
+    class Node : public PrefixField<P>
     {
-        static_assert(is_comparable<K>::value, "Key type must be totally ordered");
         public:
-            typedef jss::shared_ptr<Node<K>> SPtr;
-            typedef jss::atomic_shared_ptr<Node<K>> ASPtr;
-            typedef jss::markable_atomic_shared_ptr<Node<K>> MASPtr;
+            typedef K Key;
+            typedef P Prefix;
+            typedef typename R::template Pointer<Node<K, R, A, P>> SPtr;
+            typedef typename R::template Link<Node<K, R, A, P>> MASPtr;
 
         private:
             K priority;
             int level;
-            std::vector<MASPtr> next;
             std::atomic<bool> inserting;
+            std::atomic<int> links;
+
+            MASPtr* GetTower() const
+            {
+                return reinterpret_cast<MASPtr*>(reinterpret_cast<char*>(const_cast<Node*>(this)) +
+                                                 TowerOffset<Node, MASPtr>());
+            }
+
+            void BuildTower()
+            {
+                for (int level = 0; level < this->level; ++level)
+                {
+                    new (&this->GetTower()[level]) MASPtr();
+                }
+            }
 
         public:
-            Node(const K& priority, int level) : priority(priority), level(level), next(level), inserting(true)
+            Node(const K& priority, int level) : PrefixField<P>(priority), priority(priority), level(level),
+                 inserting(true), links(level)
+            {
+                this->BuildTower();
+            }
+
+            ~Node()
             {
+                for (int level = 0; level < this->level; ++level)
+                {
+                    this->GetTower()[level].~MASPtr();
+                }
+            }
+
+            Node(const Node&) = delete;
+            Node& operator=(const Node&) = delete;
+
+            static std::size_t GetBlockSize(int level)
+            {
+                return TowerOffset<Node, MASPtr>() + level * sizeof(MASPtr);
+            }
+
+            // Lets the calling thread create count nodes of the given level without going to the system allocator
+            static void Reserve(int level, std::size_t count)
+            {
+                A::template Reserve<Node>(GetBlockSize(level), level, count);
+            }
+
+            static void* operator new(std::size_t, int level)
+            {
+                return A::template Allocate<Node>(GetBlockSize(level), level);
+            }
+
+            static void operator delete(void* memory, int)
+            {
+                A::template Free<Node>(memory);
+            }
+
+            static void operator delete(void* memory)
+            {
+                A::template Free<Node>(memory);
             }
 
             SPtr GetNextPointer(int level) const
             {
-                return this->next[level].load();
+                return this->GetTower()[level].load();
             }
 
             bool IsNextMarked(int level) const
             {
-                return this->next[level].is_marked();
+                return this->GetTower()[level].is_marked();
             }
 
             std::pair<SPtr , bool> GetNextPointerAndMark(int level) const
             {
-                return this->next[level].load_marked();
+                return this->GetTower()[level].load_marked();
             }
 
             int GetLevel() const
@@ -48,7 +126,7 @@ namespace CSLPQ
                 return this->level;
             }
 
-            K GetPriority() const
+            KeyReference<K> GetPriority() const
             {
                 return this->priority;
             }
@@ -60,91 +138,194 @@ namespace CSLPQ
 
             void SetNext(int level, SPtr node)
             {
-                this->next[level] = node;
+                this->GetTower()[level] = node;
             }
 
             void SetNextMark(int level)
             {
-                this->next[level].set_mark();
+                this->GetTower()[level].set_mark();
             }
 
             bool TestAndSetMark(int level, SPtr& expected)
             {
-                return this->next[level].test_and_set_mark(expected);
+                return this->GetTower()[level].test_and_set_mark(expected);
             }
 
             bool CompareExchange(int level, SPtr& old_value, SPtr new_value)
             {
-                return this->next[level].compare_exchange_weak(old_value, new_value);
+                return this->GetTower()[level].compare_exchange_weak(old_value, new_value);
             }
 
             void SetDoneInserting()
             {
                 this->inserting.store(false);
             }
+
+            // Called once for every level the node gets unlinked from, returns true when that was the last one.
+            bool ReleaseLink()
+            {
+                return this->links.fetch_sub(1) == 1;
+            }
+    };
+
+    // Tag for the KVNode constructor that builds the value in place
+    struct Emplace
+    {
     };
 
-    template<typename K, typename V>
-    class KVNode
+    // Compile time 0 .. N - 1, for unpacking a tuple of constructor arguments (std::index_sequence is C++14)
+    template<std::size_t... I>
+    struct Indices
     {
-        static_assert(is_comparable<K>::value, "Key type must be totally ordered");
-        static_assert(std::is_move_constructible<V>::value || std::is_copy_constructible<V>::value ||
-                      std::is_default_constructible<V>::value || std::is_fundamental<V>::value, 
-                      "Value type must be fundamental, or default constructible, or copy or move constructible");
+    };
+
+    template<std::size_t N, std::size_t... I>
+    struct MakeIndices : MakeIndices<N - 1, N - 1, I...>
+    {
+    };
+
+    template<std::size_t... I>
+    struct MakeIndices<0, I...>
+    {
+        typedef Indices<I...> Type;
+    };
+
+    template<typename K, typename V, typename R = SharedReclamation, typename A = DefaultAllocator,
+             typename P = NoPrefix>
+    class KVNode : public PrefixField<P>
+    {
+        static_assert(std::is_destructible<V>::value, "Value type must be destructible");
         public:
-            typedef jss::shared_ptr<KVNode<K, V>> SPtr;
-            typedef jss::atomic_shared_ptr<KVNode<K, V>> ASPtr;
-            typedef jss::markable_atomic_shared_ptr<KVNode<K, V>> MASPtr;
+            typedef K Key;
+            typedef P Prefix;
+            typedef typename R::template Pointer<KVNode<K, V, R, A, P>> SPtr;
+            typedef typename R::template Link<KVNode<K, V, R, A, P>> MASPtr;
 
         private:
             K priority;
             V data;
             int level;
-            std::vector<MASPtr> next;
             std::atomic<bool> inserting;
+            std::atomic<int> links;
+            std::atomic<uint32_t> readers;
+
+            template <typename... Args, std::size_t... I>
+            KVNode(const K& priority, std::tuple<Args...>&& args, Indices<I...>, int level) :
+                   PrefixField<P>(priority), priority(priority), data(std::forward<Args>(std::get<I>(args))...),
+                   level(level), inserting(true), links(level), readers(0)
+            {
+                this->BuildTower();
+            }
+
+            // Values that cannot be copied cannot be peeked at either, so nothing reads them before the pop
+            V TakeData(std::false_type)
+            {
+                return std::move(this->data);
+            }
+
+            V TakeData(std::true_type)
+            {
+                // A peek that got in before the mark may still be copying the value, leave it intact for it
+                if (this->readers.load())
+                {
+                    return this->data;
+                }
+                return std::move(this->data);
+            }
+
+            MASPtr* GetTower() const
+            {
+                return reinterpret_cast<MASPtr*>(reinterpret_cast<char*>(const_cast<KVNode*>(this)) +
+                                                 TowerOffset<KVNode, MASPtr>());
+            }
+
+            void BuildTower()
+            {
+                for (int level = 0; level < this->level; ++level)
+                {
+                    new (&this->GetTower()[level]) MASPtr();
+                }
+            }
 
         public:
             template <typename T = V>
-            KVNode(const K& priority, int level, 
-                   typename std::enable_if<std::is_default_constructible<T>::value, int>::type = 0) : priority(priority),
-                   data(V()), level(level), next(level), inserting(true)
+            KVNode(const K& priority, int level,
+                   typename std::enable_if<std::is_default_constructible<T>::value, int>::type = 0) :
+                   PrefixField<P>(priority), priority(priority), data(), level(level), inserting(true), links(level),
+                   readers(0)
             {
+                this->BuildTower();
             }
 
-            template <typename T = V>
-            KVNode(const K& priority, const V& value, int level, 
-                   typename std::enable_if<std::is_fundamental<T>::value, int>::type = 0) : priority(priority), 
-                   data(value), level(level), next(level), inserting(true)
+            KVNode(const K& priority, const V& value, int level) : PrefixField<P>(priority), priority(priority),
+                   data(value), level(level), inserting(true), links(level), readers(0)
             {
+                this->BuildTower();
             }
 
-            template <typename T = V>
-            KVNode(const K& priority, const V& value, int level,
-                   typename std::enable_if<std::is_move_constructible<T>::value && !std::is_fundamental<T>::value, int>::type = 0) : 
-                   priority(priority), data(std::move(value)), level(level), next(level), inserting(true)
+            KVNode(const K& priority, V&& value, int level) : PrefixField<P>(priority), priority(priority),
+                   data(std::move(value)), level(level), inserting(true), links(level), readers(0)
             {
+                this->BuildTower();
             }
 
-            template <typename T = V>
-            KVNode(const K& priority, const V& value, int level,
-                   typename std::enable_if<std::is_copy_constructible<T>::value && !std::is_move_constructible<T>::value, int>::type = 0) : 
-                   priority(priority), data(value), level(level), next(level), inserting(true)
+            // Constructs the value in place from the arguments packed by std::forward_as_tuple
+            template <typename... Args>
+            KVNode(const K& priority, Emplace, std::tuple<Args...>&& args, int level) :
+                   KVNode(priority, std::move(args), typename MakeIndices<sizeof...(Args)>::Type(), level)
+            {
+            }
+
+            ~KVNode()
+            {
+                for (int level = 0; level < this->level; ++level)
+                {
+                    this->GetTower()[level].~MASPtr();
+                }
+            }
+
+            KVNode(const KVNode&) = delete;
+            KVNode& operator=(const KVNode&) = delete;
+
+            static std::size_t GetBlockSize(int level)
+            {
+                return TowerOffset<KVNode, MASPtr>() + level * sizeof(MASPtr);
+            }
+
+            // Lets the calling thread create count nodes of the given level without going to the system allocator
+            static void Reserve(int level, std::size_t count)
+            {
+                A::template Reserve<KVNode>(GetBlockSize(level), level, count);
+            }
+
+            static void* operator new(std::size_t, int level)
+            {
+                return A::template Allocate<KVNode>(GetBlockSize(level), level);
+            }
+
+            static void operator delete(void* memory, int)
+            {
+                A::template Free<KVNode>(memory);
+            }
+
+            static void operator delete(void* memory)
             {
+                A::template Free<KVNode>(memory);
             }
 
             SPtr GetNextPointer(int level) const
             {
-                return this->next[level].load();
+                return this->GetTower()[level].load();
             }
 
             bool IsNextMarked(int level) const
             {
-                return this->next[level].is_marked();
+                return this->GetTower()[level].is_marked();
             }
 
             std::pair<SPtr , bool> GetNextPointerAndMark(int level) const
             {
-                return this->next[level].load_marked();
+                return this->GetTower()[level].load_marked();
             }
 
             int GetLevel() const
@@ -152,16 +333,38 @@ namespace CSLPQ
                 return this->level;
             }
 
-            K GetPriority() const
+            KeyReference<K> GetPriority() const
             {
                 return this->priority;
             }
 
-            V GetData() const
+            // Only for when nothing can be popping the node, such as printing the queue
+            const V& GetData() const
             {
                 return this->data;
             }
 
+            // Copies the value out of a node nobody has claimed, fails once a pop has. Registering as a reader before
+            // checking the mark, against the pop marking before checking for readers, means either the peek sees the
+            // mark or the pop sees the peek.
+            bool PeekData(V& data)
+            {
+                this->readers.fetch_add(1);
+                bool unclaimed = !this->IsNextMarked(0);
+                if (unclaimed)
+                {
+                    data = this->data;
+                }
+                this->readers.fetch_sub(1);
+                return unclaimed;
+            }
+
+            // Hands the value over to the thread that claimed the node, moving it unless a peek is still reading it
+            V TakeData()
+            {
+                return this->TakeData(std::integral_constant<bool, std::is_copy_constructible<V>::value>());
+            }
+
             bool IsInserting() const
             {
                 return this->inserting.load();
@@ -169,28 +372,34 @@ namespace CSLPQ
 
             void SetNext(int level, SPtr node)
             {
-                this->next[level] = node;
+                this->GetTower()[level] = node;
             }
 
             void SetNextMark(int level)
             {
-                this->next[level].set_mark();
+                this->GetTower()[level].set_mark();
             }
 
             bool TestAndSetMark(int level, SPtr& expected)
             {
-                return this->next[level].test_and_set_mark(expected);
+                return this->GetTower()[level].test_and_set_mark(expected);
             }
 
             bool CompareExchange(int level, SPtr& old_value, SPtr new_value)
             {
-                return this->next[level].compare_exchange_weak(old_value, new_value);
+                return this->GetTower()[level].compare_exchange_weak(old_value, new_value);
             }
 
             void SetDoneInserting()
             {
                 this->inserting.store(false);
             }
+
+            // Called once for every level the node gets unlinked from, returns true when that was the last one.
+            bool ReleaseLink()
+            {
+                return this->links.fetch_sub(1) == 1;
+            }
     };
 }
 
@@ -0,0 +1,101 @@
+#ifndef __CSLPQ_PARKING_HPP__
+#define __CSLPQ_PARKING_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace CSLPQ
+{
+    // Where threads waiting on a queue sleep until another thread changes it. A waiter registers itself with Prepare,
+    // checks the queue once more, and only then sleeps with the key Prepare returned, so a change landing in between
+    // is never missed. Registration and the notifier's check of the waiter count are both sequentially consistent,
+    // as are the queue operations they come after, so either the waiter sees the change or the notifier sees the
+    // waiter.
+    //
+    // Notify is a single load while nobody waits, which keeps the queue operations that call it free of the mutex.
+    // Sleeping goes through a condition variable, a futex wait on Linux.
+    class ParkingLot
+    {
+        private:
+            std::atomic<uint32_t> waiters;
+            std::atomic<uint32_t> epoch;
+            std::mutex mutex;
+            std::condition_variable condition;
+
+        public:
+            ParkingLot() : waiters(0), epoch(0)
+            {
+            }
+
+            ParkingLot(const ParkingLot&) = delete;
+            ParkingLot& operator=(const ParkingLot&) = delete;
+
+            // Counts the caller as a waiter, it must follow up with Cancel or one of the waits
+            uint32_t Prepare()
+            {
+                this->waiters.fetch_add(1);
+                return this->epoch.load();
+            }
+
+            void Cancel()
+            {
+                this->waiters.fetch_sub(1);
+            }
+
+            // Sleeps until a notify comes after the Prepare that returned key
+            void Wait(uint32_t key)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(this->mutex);
+                    this->condition.wait(lock, [this, key]() { return this->epoch.load() != key; });
+                }
+                this->waiters.fetch_sub(1);
+            }
+
+            // Same, but gives up at deadline, returns false if it did
+            template<typename Clock, typename Duration>
+            bool WaitUntil(uint32_t key, const std::chrono::time_point<Clock, Duration>& deadline)
+            {
+                bool notified;
+                {
+                    std::unique_lock<std::mutex> lock(this->mutex);
+                    notified = this->condition.wait_until(lock, deadline,
+                                                          [this, key]() { return this->epoch.load() != key; });
+                }
+                this->waiters.fetch_sub(1);
+                return notified;
+            }
+
+            // Wakes one waiter, if there are any
+            void Notify()
+            {
+                if (!this->waiters.load())
+                {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(this->mutex);
+                    this->epoch++;
+                }
+                this->condition.notify_one();
+            }
+
+            void NotifyAll()
+            {
+                if (!this->waiters.load())
+                {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(this->mutex);
+                    this->epoch++;
+                }
+                this->condition.notify_all();
+            }
+    };
+}
+
+#endif // __CSLPQ_PARKING_HPP__
@@ -40,8 +40,10 @@
 #ifndef _JSS_ATOMIC_SHARED_PTR
 #define _JSS_ATOMIC_SHARED_PTR
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <deque>
+#include <stdexcept>
 #include "Atomic128.hpp"
 
 namespace jss{
@@ -331,6 +333,8 @@ namespace jss{
             template<typename U>
             friend class markable_atomic_shared_ptr;
             template<typename U>
+            friend class tagged_markable_atomic_shared_ptr;
+            template<typename U>
             friend class shared_ptr;
 
             template<typename U,typename ... Args>
@@ -1054,6 +1058,245 @@ namespace jss{
             }
 
     };
+
+    // Same interface as markable_atomic_shared_ptr, with the header pointer, its alias index, the mark and the count
+    // of local accesses in flight packed into one 64 bit word instead of a 16 byte one:
+    //     bit 0: mark, bits 1-2: alias index, bits 3-47: header pointer, bits 48-63: access count
+    // Every operation is then an 8 byte atomic rather than a cmpxchg16b. is_marked and set_mark are a plain load and
+    // a fetch_or, a load takes one fetch_add to count itself in and one CAS to count itself out, and a successful CAS
+    // is one CAS unless a concurrent load changed the count in between.
+    //
+    // This relies on user space addresses fitting in 48 bits, as on x86-64 and AArch64 with 4 level page tables, on
+    // headers being 8 byte aligned, on pointers being stored with one of the first 4 alias indices (nodes always use
+    // the first), and on fewer than 32768 local accesses to one link being in flight at once. A pointer that does not
+    // fit throws std::invalid_argument when stored.
+    template <class T>
+    class tagged_markable_atomic_shared_ptr
+    {
+            template<typename U>
+            friend class tagged_markable_atomic_shared_ptr;
+
+            static const uint64_t mark_bit=1;
+            static const unsigned index_shift=1;
+            static const uint64_t index_mask=uint64_t(3)<<index_shift;
+            static const uint64_t pointer_mask=0x0000fffffffffff8ull;
+            static const uint64_t target_mask=pointer_mask|index_mask;
+            static const unsigned count_shift=48;
+            static const uint64_t count_one=uint64_t(1)<<count_shift;
+
+            mutable std::atomic<uint64_t> p;
+
+            static shared_ptr_header_block_base* get_header(uint64_t value)
+            {
+                return reinterpret_cast<shared_ptr_header_block_base*>(value&pointer_mask);
+            }
+
+            static unsigned get_index(uint64_t value)
+            {
+                return (value&index_mask)>>index_shift;
+            }
+
+            static unsigned get_count(uint64_t value)
+            {
+                return value>>count_shift;
+            }
+
+            static uint64_t pack(const shared_ptr<T>& ptr)
+            {
+                if(!ptr.header)
+                    return 0;
+                uint64_t header=reinterpret_cast<uint64_t>(ptr.header);
+                uint64_t index=ptr.header->get_ptr_index(ptr.ptr);
+                if((header&~pointer_mask) || (index>(index_mask>>index_shift)))
+                    throw std::invalid_argument("pointer does not fit in a tagged_markable_atomic_shared_ptr");
+                return header|(index<<index_shift);
+            }
+
+            // Hands the access count a replaced value still had over to its header, and drops the reference the
+            // link held. The count is signed: a load that started on an earlier store of the same pointer (A, B, A
+            // again) counts itself out of the later one, leaving it at -1 until it is replaced in turn and the -1
+            // cancels the +1 its header got when the earlier store was replaced.
+            static void release_replaced(uint64_t old)
+            {
+                shared_ptr_header_block_base* header=get_header(old);
+                if(!header)
+                    return;
+                if(get_count(old))
+                    header->add_external_counters(unsigned(int(int16_t(get_count(old)))));
+                header->dec_count();
+            }
+
+            struct local_access{
+                std::atomic<uint64_t>& p;
+                uint64_t val;
+                bool counted;
+
+                explicit local_access(std::atomic<uint64_t>& p_):
+                        p(p_),val(p.load()),counted(false)
+                {
+                    // Null links, the ends of every level, need no count
+                    if(get_header(val)){
+                        val=p.fetch_add(count_one);
+                        counted=true;
+                    }
+                }
+
+                ~local_access()
+                {
+                    if(!counted)
+                        return;
+                    uint64_t target=p.load();
+                    while((target&target_mask)==(val&target_mask)){
+                        if(p.compare_exchange_weak(target,target-count_one))
+                            return;
+                    }
+                    // Replaced since, whoever did it moved our count to the header. A null that got stored after our
+                    // load took our count with it when it was replaced.
+                    if(get_header(val))
+                        get_header(val)->remove_external_counter();
+                }
+
+                shared_ptr<T> get_shared_ptr()
+                {
+                    return shared_ptr<T>(get_header(val),get_index(val));
+                }
+
+                bool is_marked() const
+                {
+                    return val&mark_bit;
+                }
+            };
+
+        public:
+
+            bool is_lock_free() const noexcept
+            {
+                return p.is_lock_free();
+            }
+
+            void store(
+                    shared_ptr<T> newptr,
+                    std::memory_order order= std::memory_order_seq_cst) /*noexcept*/
+            {
+                release_replaced(p.exchange(pack(newptr),order));
+                newptr.clear();
+            }
+
+            shared_ptr<T> load(
+                    std::memory_order order= std::memory_order_seq_cst) const noexcept
+            {
+                local_access guard(p);
+                return guard.get_shared_ptr();
+            }
+
+            operator shared_ptr<T>() const noexcept {
+                return load();
+            }
+
+            bool is_marked(std::memory_order order= std::memory_order_seq_cst) const noexcept
+            {
+                return p.load(order)&mark_bit;
+            }
+
+            std::pair<shared_ptr<T>, bool> load_marked(std::memory_order order= std::memory_order_seq_cst) const noexcept
+            {
+                local_access guard(p);
+                return std::make_pair(guard.get_shared_ptr(), guard.is_marked());
+            }
+
+            shared_ptr<T> exchange(
+                    shared_ptr<T> newptr,
+                    std::memory_order order= std::memory_order_seq_cst) /*noexcept*/
+            {
+                uint64_t old=p.exchange(pack(newptr),order);
+                shared_ptr<T> res(get_header(old),get_index(old));
+                release_replaced(old);
+                newptr.clear();
+                return res;
+            }
+
+            void set_mark() noexcept
+            {
+                p.fetch_or(mark_bit);
+            }
+
+            // Marks the pointer if it is unmarked, retrying as long as it stays unmarked. On failure expected is
+            // refreshed with the current pointer.
+            bool test_and_set_mark(
+                    shared_ptr<T> & expected,
+                    std::memory_order success_order=std::memory_order_seq_cst,
+                    std::memory_order failure_order=std::memory_order_seq_cst) /*noexcept*/
+            {
+                uint64_t current=p.load();
+                while(!(current&mark_bit)){
+                    if(p.compare_exchange_weak(current,current|mark_bit,success_order,failure_order))
+                        return true;
+                }
+                expected=load();
+                return false;
+            }
+
+            // Fails if the pointer is marked or is not expected, then expected is refreshed with the current pointer.
+            // A count that changed under the CAS is not a failure, it is retried.
+            bool compare_exchange_weak(
+                    shared_ptr<T> & expected, shared_ptr<T> newptr,
+                    std::memory_order success_order=std::memory_order_seq_cst,
+                    std::memory_order failure_order=std::memory_order_seq_cst) /*noexcept*/
+            {
+                uint64_t expectedval=pack(expected);
+                uint64_t newval=pack(newptr);
+                uint64_t current=p.load();
+                while((current&(target_mask|mark_bit))==expectedval){
+                    if(newval==expectedval)
+                        return true;
+                    if(p.compare_exchange_weak(current,newval,success_order,failure_order)){
+                        release_replaced(current);
+                        newptr.clear();
+                        return true;
+                    }
+                }
+                expected=load();
+                return false;
+            }
+
+            bool compare_exchange_strong(
+                    shared_ptr<T> &expected,shared_ptr<T> newptr,
+                    std::memory_order success_order=std::memory_order_seq_cst,
+                    std::memory_order failure_order=std::memory_order_seq_cst)
+            {
+                shared_ptr<T> local_expected=expected;
+                do{
+                    if(compare_exchange_weak(expected,newptr,success_order,failure_order))
+                        return true;
+                }
+                while(expected==local_expected);
+                return false;
+            }
+
+            tagged_markable_atomic_shared_ptr() noexcept:
+                    p(0)
+            {}
+
+            tagged_markable_atomic_shared_ptr( shared_ptr<T> val) /*noexcept*/:
+                    p(pack(val))
+            {
+                val.clear();
+            }
+
+            ~tagged_markable_atomic_shared_ptr()
+            {
+                release_replaced(p.load());
+            }
+
+            tagged_markable_atomic_shared_ptr(const tagged_markable_atomic_shared_ptr&) = delete;
+            tagged_markable_atomic_shared_ptr& operator=(const tagged_markable_atomic_shared_ptr&) = delete;
+            shared_ptr<T> operator=(shared_ptr<T> newval)
+            {
+                store(static_cast<shared_ptr<T>&&>(newval));
+                return newval;
+            }
+
+    };
 }
 
 #endif
\ No newline at end of file
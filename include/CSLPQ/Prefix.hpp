@@ -0,0 +1,104 @@
+#ifndef __CSLPQ_PREFIX_HPP__
+#define __CSLPQ_PREFIX_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+namespace CSLPQ
+{
+    // A prefix policy maps keys to 64 bit prefixes that nodes keep in their header, so that searches can order most
+    // nodes they pass without reading their keys. Every policy provides:
+    //  - enabled: whether nodes keep a prefix at all.
+    //  - Get(key): the prefix of key. Whenever the comparator puts a before b, Get(a) <= Get(b), and keys neither
+    //    comes before have equal prefixes. Keys are only compared when their prefixes are equal.
+    struct NoPrefix
+    {
+        static const bool enabled = false;
+
+        template<typename K>
+        static uint64_t Get(const K&)
+        {
+            return 0;
+        }
+    };
+
+    // The first 8 characters of a string, big endian and zero padded, for std::string keys ordered by std::less.
+    // Their prefixes go against any other order, see is_prefix_ordered_by.
+    struct StringPrefix
+    {
+        static const bool enabled = true;
+
+        static uint64_t Get(const std::string& key)
+        {
+            uint64_t prefix = 0;
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+                prefix <<= 8;
+                if (i < key.size())
+                {
+                    prefix |= static_cast<unsigned char>(key[i]);
+                }
+            }
+            return prefix;
+        }
+    };
+
+    // Whether the prefixes of P follow the order of comparator C, as Get requires. Searches order nodes by prefix
+    // ascending, so a policy that does not would misorder keys without any error. Policies are taken at their word,
+    // except StringPrefix, which only follows std::less<std::string>.
+    template<typename P, typename C>
+    struct is_prefix_ordered_by : std::true_type
+    {
+    };
+
+    template<typename C>
+    struct is_prefix_ordered_by<StringPrefix, C> : std::false_type
+    {
+    };
+
+    template<>
+    struct is_prefix_ordered_by<StringPrefix, std::less<std::string>> : std::true_type
+    {
+    };
+
+    // Where a node keeps the prefix of its key, an empty base without one
+    template<typename P, bool Enabled = P::enabled>
+    class PrefixField
+    {
+        private:
+            uint64_t prefix;
+
+        protected:
+            template<typename K>
+            explicit PrefixField(const K& key) : prefix(P::Get(key))
+            {
+            }
+
+        public:
+            uint64_t GetPrefix() const
+            {
+                return this->prefix;
+            }
+    };
+
+    template<typename P>
+    class PrefixField<P, false>
+    {
+        protected:
+            template<typename K>
+            explicit PrefixField(const K&)
+            {
+            }
+
+        public:
+            uint64_t GetPrefix() const
+            {
+                return 0;
+            }
+    };
+}
+
+#endif // __CSLPQ_PREFIX_HPP__
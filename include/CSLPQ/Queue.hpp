@@ -1,277 +1,241 @@
 #ifndef __CSLPQ_QUEUE_HPP__
 #define __CSLPQ_QUEUE_HPP__
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <utility>
 #include <vector>
-#include <random>
 #include <tuple>
 #include <sstream>
 
 #include "Concepts.hpp"
 #include "Node.hpp"
+#include "SkipList.hpp"
+#include "Epoch.hpp"
+#include "Hazard.hpp"
+#include "Allocator.hpp"
 
 namespace CSLPQ
 {
-    template<typename K>
-    class Queue
+    // Keys come out smallest first by Compare, std::greater<K> pops the largest first instead. Count is the counting
+    // policy behind GetSize: ExactCount, ShardedCount or NoCount. Prefix is the prefix policy searches order nodes by
+    // before comparing keys, see Prefix.hpp.
+    template<typename K, typename R = SharedReclamation, typename A = DefaultAllocator, uint32_t MaxLevel = 0,
+             typename Compare = std::less<K>, typename Count = ExactCount, typename Prefix = NoPrefix>
+    class Queue : public SkipList<Node<K, R, A, Prefix>, R, MaxLevel, Compare, Count>
     {
-        static_assert(is_comparable<K>::value, "Key type must be totally ordered");
+        static_assert(is_ordered_by<K, Compare>::value, "Key type must be totally ordered by Compare");
         private:
-            typedef jss::shared_ptr<Node<K>> SPtr;
+            typedef Node<K, R, A, Prefix> N;
+            typedef SkipList<N, R, MaxLevel, Compare, Count> Base;
+            typedef typename Base::SPtr SPtr;
+            typedef typename Base::Guard Guard;
 
-            const uint32_t max_level;
-            const uint32_t max_size;
-            SPtr head;
-            std::atomic<uint32_t> size;
-
-            void Wait()
+        public:
+            // A node reaches each next level with probability level_probability. preallocate nodes are set aside
+            // for the constructing thread, if the allocator keeps a pool.
+            explicit Queue(uint32_t max_level = MaxLevel ? MaxLevel : 4, uint32_t max_size = 0,
+                           double level_probability = 0.5,
+                           const typename R::Parameters& parameters = typename R::Parameters(),
+                           uint32_t preallocate = 0, const Compare& compare = Compare()) :
+                           Base(max_level, max_size, level_probability, parameters, preallocate, compare)
             {
-                if (this->max_size)
-                {
-                    while (this->size >= this->max_size);
-                }
             }
 
-            uint32_t GenerateRandomLevel()
-            {
-                static std::random_device rd;
-                static std::mt19937 mt(rd());
-                static std::uniform_int_distribution<uint32_t> dist(1, this->max_level + 1);
-
-                return dist(mt);
-            }
+            Queue(const Queue&) = delete;
 
-            void FindLastOfPriority(const K& priority, std::vector<SPtr>& predecessors,
-                                    std::vector<SPtr>& successors)
+            Queue(Queue&& other) noexcept : Base(std::move(other))
             {
-                bool marked = false;
-                bool snip = false;
+            }
 
-                SPtr predecessor;
-                SPtr current;
-                SPtr successor;
+            Queue& operator=(const Queue&) = delete;
 
-                bool retry;
-                while (true)
-                {
-                    retry = false;
-                    predecessor = this->head;
-                    for (int64_t level = this->max_level; level >= 0; --level)
-                    {
-                        current = predecessor->GetNextPointer(level);
-                        while (current)
-                        {
-                            std::tie(successor, marked) = current->GetNextPointerAndMark(level);
-                            while (marked)
-                            {
-                                snip = predecessor->CompareExchange(level, current, successor);
-                                if (!snip)
-                                {
-                                    retry = true;
-                                    break;
-                                }
-                                current = successor;
-                                if (!current)
-                                {
-                                    marked = false;
-                                }
-                                else
-                                {
-                                    std::tie(successor, marked) = current->GetNextPointerAndMark(level);
-                                }
-                            }
-                            if (retry)
-                            {
-                                break;
-                            }
-                            if (!current)
-                            {
-                                break;
-                            }
-                            if (current->GetPriority() < priority)
-                            {
-                                predecessor = current;
-                                current = successor;
-                            }
-                            else
-                            {
-                                break;
-                            }
-                        }
-                        if (retry)
-                        {
-                            break;
-                        }
-                        predecessors[level] = predecessor;
-                        successors[level] = current;
-                    }
-                    if (!retry)
-                    {
-                        break;
-                    }
-                }
+            void Push(const K& priority)
+            {
+                this->ReserveSlot();
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), priority);
+                this->Insert(guard, new_node);
             }
 
-            SPtr FindFirst()
+            // Pushes the keys in [first, last). They are sorted first and inserted in increasing order under a single
+            // guard, every search starting from where the previous key went instead of from the head, and the size is
+            // updated once for all of them. Bounded queues push them one at a time, a batch might not fit.
+            template<typename Iterator>
+            void PushBatch(Iterator first, Iterator last)
             {
-                bool marked = false;
-                bool snip = false;
-
-                SPtr predecessor;
-                SPtr current;
-                SPtr successor;
-                SPtr empty;
-
-                bool retry;
-                while (true)
+                std::vector<K> keys(first, last);
+                if (this->max_size)
                 {
-                    retry = false;
-                    predecessor = this->head;
-                    for (int64_t level = this->max_level; level >= 0; --level)
+                    for (const K& key : keys)
                     {
-                        current = predecessor->GetNextPointer(level);
-                        if (current)
-                        {
-                            std::tie(successor, marked) = current->GetNextPointerAndMark(level);
-                            while (marked)
-                            {
-                                snip = predecessor->CompareExchange(level, current, successor);
-                                if (!snip)
-                                {
-                                    retry = true;
-                                    break;
-                                }
-                                current = successor;
-                                if (!current)
-                                {
-                                    marked = false;
-                                }
-                                else
-                                {
-                                    std::tie(successor, marked) = current->GetNextPointerAndMark(level);
-                                }
-                            }
-                            if (retry)
-                            {
-                                break;
-                            }
-                            if (level == 0)
-                            {
-                                return current;
-                            }
-                        }
-                        else if (level == 0)
-                        {
-                            return empty;
-                        }
+                        this->Push(key);
                     }
+                    return;
+                }
+                std::sort(keys.begin(), keys.end(), [this](const K& a, const K& b) { return this->Less(a, b); });
+                this->size.Add(keys.size());
+                Guard guard(this->reclamation);
+                SPtr predecessors[Base::level_limit];
+                SPtr successors[Base::level_limit];
+                bool hinted = false;
+                for (const K& key : keys)
+                {
+                    SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), key);
+                    this->Insert(guard, new_node, predecessors, successors, hinted);
+                    hinted = true;
                 }
             }
 
-        public:
-            explicit Queue(uint32_t max_level = 4, uint32_t max_size = 0) : max_level(max_level), max_size(max_size),
-                           head(new Node<K>(K(), max_level + 1)), size(0)
+            // Push that returns false instead of waiting when a bounded queue is full
+            bool TryPush(const K& priority)
             {
+                if (!this->TryReserveSlot())
+                {
+                    return false;
+                }
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), priority);
+                this->Insert(guard, new_node);
+                return true;
             }
 
-            Queue(const Queue&) = delete;
-
-            Queue(Queue&& other) noexcept : max_level(other.max_level), max_size(other.max_size), head(other.head),
-                  size(other.size)
+            // Reads the smallest key without removing it, returns false if the queue is empty. Keys still being pushed
+            // are passed over, same as in TryPop. The key may be popped by another thread by the time this returns.
+            bool TryPeek(K& priority)
             {
-                other.head = nullptr;
-            }
-
-            Queue& operator=(const Queue&) = delete;
-
-            Queue& operator=(Queue&& other) noexcept
-            {
-                this->max_level = other.max_level;
-                this->max_size = other.max_size;
-                this->head = other.head;
-                this->size = other.size;
-                other.head = nullptr;
-                return *this;
+                Guard guard(this->reclamation);
+                SPtr first = this->PeekFirst(guard);
+                if (!first)
+                {
+                    return false;
+                }
+                priority = first->GetPriority();
+                return true;
             }
 
-            void Push(const K& priority)
+            // Same, but only reads the smallest key if it comes before the one priority already holds, and returns
+            // false otherwise
+            bool TryPeekBefore(K& priority)
             {
-                this->Wait();
-                uint32_t new_level = this->GenerateRandomLevel();
-                SPtr new_node(new Node<K>(priority, new_level));
-                std::vector<SPtr> predecessors(this->max_level + 1);
-                std::vector<SPtr> successors(this->max_level + 1);
-
-                while (true)
+                Guard guard(this->reclamation);
+                SPtr first = this->PeekFirst(guard);
+                if (!first || !this->Less(first->GetPriority(), priority))
                 {
-                    this->FindLastOfPriority(priority, predecessors, successors);
-                    for (uint32_t level = 0; level < new_level; ++level)
-                    {
-                        new_node->SetNext(level, successors[level]);
-                    }
-                    if (!predecessors[0]->CompareExchange(0, successors[0], new_node))
-                    {
-                        continue;
-                    }
-                    for (uint32_t level = 1; level < new_level; ++level)
-                    {
-                        while (true)
-                        {
-                            if (predecessors[level]->CompareExchange(level, successors[level], new_node))
-                            {
-                                break;
-                            }
-                            this->FindLastOfPriority(priority, predecessors, successors);
-                        }
-                    }
-                    break;
+                    return false;
                 }
-                new_node->SetDoneInserting();
-                this->size++;
+                priority = first->GetPriority();
+                return true;
             }
 
+            // Pops the smallest key, returns false only if the queue was empty. Losing it to another pop makes it try
+            // the next one, and keys still being pushed are passed over, they count as pushed once their push returns.
             bool TryPop(K& priority)
             {
-                SPtr successor;
-                SPtr first = this->FindFirst();
-
+                Guard guard(this->reclamation);
+                SPtr first = this->TryClaimFirst(guard);
                 if (!first)
                 {
                     return false;
                 }
-                if (first->IsInserting())
-                {
-                    return false;
-                }
+                priority = first->GetPriority();
+                return true;
+            }
 
-                for (uint32_t level = first->GetLevel() - 1; level >= 1; --level)
+            // Same, but makes a single attempt and says why it failed, so callers can back off on Contended
+            PopStatus TryPopOnce(K& priority)
+            {
+                Guard guard(this->reclamation);
+                SPtr first = nullptr;
+                PopStatus status = this->TryClaimFirstOnce(guard, first);
+                if (status == PopStatus::Success)
                 {
-                    first->SetNextMark(level);
+                    priority = first->GetPriority();
                 }
+                return status;
+            }
 
-                successor = first->GetNextPointer(0);
-                priority = first->GetPriority();
-                bool success = first->TestAndSetMark(0, successor);
-                if (success)
+            // Pops up to n of the smallest keys into out and returns how many. They are claimed in a single walk along
+            // the bottom level rather than a search for the first node each, and the size is updated once.
+            template<typename OutputIterator>
+            std::size_t TryPopN(OutputIterator out, std::size_t n)
+            {
+                Guard guard(this->reclamation);
+                return this->TryClaimFirstN(guard, n, [&out](const SPtr& node)
                 {
-                    this->size--;
-                    return true;
-                }
-                else
+                    *out++ = node->GetPriority();
+                });
+            }
+
+            // Pops every key that does not come after bound into out, in order, and returns how many. The keys come off
+            // the front of the bottom level in one walk that stops at the first key past bound, so nothing is popped
+            // and pushed back. Named apart from the timed PopUntil, which waits for a deadline instead.
+            template<typename OutputIterator>
+            std::size_t PopAllUpTo(const K& bound, OutputIterator out)
+            {
+                return this->ConsumeUpTo(bound, [&out](const K& priority)
                 {
-                    return false;
-                }
+                    *out++ = priority;
+                });
             }
 
-            uint32_t GetSize() const
+            // Same, but hands each popped key to callback instead
+            template<typename Callback>
+            std::size_t ConsumeUpTo(const K& bound, Callback callback)
             {
-                return this->size.load();
+                Guard guard(this->reclamation);
+                return this->TryClaimFirstWhile(guard, std::numeric_limits<std::size_t>::max(),
+                                                [this, &bound](const SPtr& node)
+                                                {
+                                                    return !this->Less(bound, node->GetPriority());
+                                                },
+                                                [&callback](const SPtr& node) { callback(node->GetPriority()); });
             }
 
+            // Blocks until a key can be popped, spinning briefly and then sleeping until a push comes in
+            void Pop(K& priority)
+            {
+                Base::Block(this->consumers, [this, &priority]() { return this->TryPop(priority); });
+            }
+
+            // Blocks until a key can be popped or timeout has passed, returns false if it passed
+            template<typename Rep, typename Period>
+            bool PopFor(K& priority, const std::chrono::duration<Rep, Period>& timeout)
+            {
+                return this->PopUntil(priority, std::chrono::steady_clock::now() + timeout);
+            }
+
+            template<typename Clock, typename Duration>
+            bool PopUntil(K& priority, const std::chrono::time_point<Clock, Duration>& deadline)
+            {
+                return Base::BlockUntil(this->consumers, [this, &priority]() { return this->TryPop(priority); },
+                                        deadline);
+            }
+
+            // Relaxed TryPop for when consumers threads pop at once and strict order does not matter. Instead of the
+            // smallest key it returns one of the first 2 * consumers * log2(consumers) keys on average. Single pops
+            // can land further out and there is no hard bound, see SkipList::TryClaimSprayed for measured ranks.
+            bool TryPopRelaxed(K& priority, uint32_t consumers)
+            {
+                Guard guard(this->reclamation);
+                SPtr node = this->TryClaimSprayed(guard, consumers);
+                if (!node)
+                {
+                    return false;
+                }
+                priority = node->GetPriority();
+                return true;
+            }
+
+            // Safe to call while other threads push and pop, see SkipList::ForEachNode
             std::string ToString(bool all_levels = false)
             {
                 static_assert(is_printable<K>::value, "Key type must be printable");
+                Guard guard(this->reclamation);
                 std::stringstream ss;
-                uint32_t max = all_levels? this->max_level : 0;
+                uint32_t max = all_levels? this->GetMaxLevel() : 0;
                 for (uint32_t level = 0; level <= max; ++level)
                 {
                     if (all_levels)
@@ -283,332 +247,322 @@ namespace CSLPQ
                         ss << "Queue: \n";
                     }
 
-                    bool marked = false;
-                    SPtr node;
-                    SPtr nnode;
-                    std::tie(node, marked) = this->head->GetNextPointerAndMark(level);
-                    while (node)
+                    std::stringstream keys;
+                    this->ForEachNode(guard, level, [&keys](const SPtr& node, bool marked)
                     {
-                        std::tie(nnode, marked) = node->GetNextPointerAndMark(level);
-                        if (!marked)
-                        {
-                            ss << "\tKey: " << node->GetPriority() << "\n";
-                        }
-                        else
-                        {
-                            ss << "\tKey: " << node->GetPriority() << " (Marked)\n";
-                        }
-                        node = nnode;
-                    }
+                        keys << "\tKey: " << node->GetPriority() << (marked ? " (Marked)\n" : "\n");
+                    },
+                    [&keys]() { keys.str(""); });
+                    ss << keys.str();
                 }
                 return ss.str();
             }
     };
 
-    template<typename K, typename V>
-    class KVQueue
+    template<typename K, typename V, typename R = SharedReclamation, typename A = DefaultAllocator,
+             uint32_t MaxLevel = 0, typename Compare = std::less<K>, typename Count = ExactCount,
+             typename Prefix = NoPrefix>
+    class KVQueue : public SkipList<KVNode<K, V, R, A, Prefix>, R, MaxLevel, Compare, Count>
     {
-        static_assert(is_comparable<K>::value, "Key type must be totally ordered");
+        static_assert(is_ordered_by<K, Compare>::value, "Key type must be totally ordered by Compare");
         static_assert(std::is_move_constructible<V>::value || std::is_copy_constructible<V>::value ||
                       std::is_default_constructible<V>::value || std::is_fundamental<V>::value, 
                       "Value type must be fundamental, or default constructible, or copy or move constructible");
         private:
-            typedef jss::shared_ptr<KVNode<K, V>> SPtr;
+            typedef KVNode<K, V, R, A, Prefix> N;
+            typedef SkipList<N, R, MaxLevel, Compare, Count> Base;
+            typedef typename Base::SPtr SPtr;
+            typedef typename Base::Guard Guard;
 
-            const uint32_t max_level;
-            const uint32_t max_size;
-            SPtr head;
-            std::atomic<uint32_t> size;
+        public:
+            // A node reaches each next level with probability level_probability. preallocate nodes are set aside
+            // for the constructing thread, if the allocator keeps a pool.
+            KVQueue(uint32_t max_level = MaxLevel ? MaxLevel : 4, uint32_t max_size = 0, double level_probability = 0.5,
+                    const typename R::Parameters& parameters = typename R::Parameters(), uint32_t preallocate = 0,
+                    const Compare& compare = Compare()) :
+                    Base(max_level, max_size, level_probability, parameters, preallocate, compare)
+            {
+            }
+
+            KVQueue(const KVQueue&) = delete;
 
-            void Wait()
+            KVQueue(KVQueue&& other) noexcept : Base(std::move(other))
             {
-                if (this->max_size)
-                {
-                    while (this->size >= this->max_size);
-                }
             }
 
-            uint32_t GenerateRandomLevel()
+            KVQueue& operator=(const KVQueue&) = delete;
+
+            void Push(const K& priority)
             {
-                static std::random_device rd;
-                static std::mt19937 mt(rd());
-                static std::uniform_int_distribution<uint32_t> dist(1, this->max_level + 1);
+                this->ReserveSlot();
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), priority);
+                this->Insert(guard, new_node);
+            }
 
-                return dist(mt);
+            void Push(const K& priority, const V& data)
+            {
+                this->ReserveSlot();
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), priority, data);
+                this->Insert(guard, new_node);
             }
 
-            void FindLastOfPriority(const K& priority, std::vector<SPtr>& predecessors,
-                                    std::vector<SPtr>& successors)
+            void Push(const K& priority, V&& data)
             {
-                bool marked = false;
-                bool snip = false;
+                this->ReserveSlot();
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), priority, std::move(data));
+                this->Insert(guard, new_node);
+            }
 
-                SPtr predecessor;
-                SPtr current;
-                SPtr successor;
+            // Pushes a value constructed in place in the node from args
+            template<typename... Args>
+            void Emplace(const K& priority, Args&&... args)
+            {
+                this->ReserveSlot();
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(
+                                    this->GenerateRandomLevel(), priority, CSLPQ::Emplace(),
+                                    std::forward_as_tuple(std::forward<Args>(args)...));
+                this->Insert(guard, new_node);
+            }
 
-                bool retry;
-                while (true)
+            // Pushes the key and value pairs in [first, last). They are sorted by key first and inserted in increasing
+            // order under a single guard, every search starting from where the previous key went instead of from the
+            // head, and the size is updated once for all of them. Bounded queues push them one at a time, a batch
+            // might not fit.
+            template<typename Iterator>
+            void PushBatch(Iterator first, Iterator last)
+            {
+                std::vector<std::pair<K, V>> items(first, last);
+                if (this->max_size)
                 {
-                    retry = false;
-                    predecessor = this->head;
-                    for (int64_t level = this->max_level; level >= 0; --level)
-                    {
-                        current = predecessor->GetNextPointer(level);
-                        while (current)
-                        {
-                            std::tie(successor, marked) = current->GetNextPointerAndMark(level);
-                            while (marked)
-                            {
-                                snip = predecessor->CompareExchange(level, current, successor);
-                                if (!snip)
-                                {
-                                    retry = true;
-                                    break;
-                                }
-                                current = successor;
-                                if (!current)
-                                {
-                                    marked = false;
-                                }
-                                else
-                                {
-                                    std::tie(successor, marked) = current->GetNextPointerAndMark(level);
-                                }
-                            }
-                            if (retry)
-                            {
-                                break;
-                            }
-                            if (!current)
-                            {
-                                break;
-                            }
-                            if (current->GetPriority() < priority)
-                            {
-                                predecessor = current;
-                                current = successor;
-                            }
-                            else
-                            {
-                                break;
-                            }
-                        }
-                        if (retry)
-                        {
-                            break;
-                        }
-                        predecessors[level] = predecessor;
-                        successors[level] = current;
-                    }
-                    if (!retry)
+                    for (std::pair<K, V>& item : items)
                     {
-                        break;
+                        this->Push(item.first, std::move(item.second));
                     }
+                    return;
+                }
+                std::sort(items.begin(), items.end(), [this](const std::pair<K, V>& a, const std::pair<K, V>& b)
+                {
+                    return this->Less(a.first, b.first);
+                });
+                this->size.Add(items.size());
+                Guard guard(this->reclamation);
+                SPtr predecessors[Base::level_limit];
+                SPtr successors[Base::level_limit];
+                bool hinted = false;
+                for (std::pair<K, V>& item : items)
+                {
+                    SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), item.first,
+                                                          std::move(item.second));
+                    this->Insert(guard, new_node, predecessors, successors, hinted);
+                    hinted = true;
                 }
             }
 
-            SPtr FindFirst()
+            // Pushes that return false instead of waiting when a bounded queue is full
+            bool TryPush(const K& priority)
             {
-                bool marked = false;
-                bool snip = false;
-
-                SPtr predecessor;
-                SPtr current;
-                SPtr successor;
-                SPtr empty;
-
-                bool retry;
-                while (true)
+                if (!this->TryReserveSlot())
                 {
-                    retry = false;
-                    predecessor = this->head;
-                    for (int64_t level = this->max_level; level >= 0; --level)
-                    {
-                        current = predecessor->GetNextPointer(level);
-                        if (current)
-                        {
-                            std::tie(successor, marked) = current->GetNextPointerAndMark(level);
-                            while (marked)
-                            {
-                                snip = predecessor->CompareExchange(level, current, successor);
-                                if (!snip)
-                                {
-                                    retry = true;
-                                    break;
-                                }
-                                current = successor;
-                                if (!current)
-                                {
-                                    marked = false;
-                                }
-                                else
-                                {
-                                    std::tie(successor, marked) = current->GetNextPointerAndMark(level);
-                                }
-                            }
-                            if (retry)
-                            {
-                                break;
-                            }
-                            if (level == 0)
-                            {
-                                return current;
-                            }
-                        }
-                        else if (level == 0)
-                        {
-                            return empty;
-                        }
-                    }
+                    return false;
                 }
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), priority);
+                this->Insert(guard, new_node);
+                return true;
             }
 
-        public:
-            KVQueue(uint32_t max_level = 4, uint32_t max_size = 0) : max_level(max_level), max_size(max_size),
-                    head(new KVNode<K, V>(K(), max_level + 1)), size(0)
+            bool TryPush(const K& priority, const V& data)
             {
+                if (!this->TryReserveSlot())
+                {
+                    return false;
+                }
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), priority, data);
+                this->Insert(guard, new_node);
+                return true;
             }
 
-            KVQueue(const KVQueue&) = delete;
-
-            KVQueue(KVQueue&& other)  noexcept : max_level(other.max_level), max_size(other.max_size), head(other.head),
-                    size(other.size)
+            // Leaves data alone if the queue is full
+            bool TryPush(const K& priority, V&& data)
             {
-                other.head = nullptr;
-                other.size = 0;
+                if (!this->TryReserveSlot())
+                {
+                    return false;
+                }
+                Guard guard(this->reclamation);
+                SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), priority, std::move(data));
+                this->Insert(guard, new_node);
+                return true;
             }
 
-            KVQueue& operator=(const KVQueue&) = delete;
-
-            KVQueue& operator=(KVQueue&& other) noexcept
+            // Reads the smallest key without removing it, returns false if the queue is empty. Keys still being pushed
+            // are passed over, same as in TryPop. The key may be popped by another thread by the time this returns.
+            bool TryPeek(K& priority)
             {
-                this->max_level = other.max_level;
-                this->max_size = other.max_size;
-                this->head = other.head;
-                this->size = other.size;
-                other.head = nullptr;
-                other.size = 0;
-                return *this;
+                Guard guard(this->reclamation);
+                SPtr first = this->PeekFirst(guard);
+                if (!first)
+                {
+                    return false;
+                }
+                priority = first->GetPriority();
+                return true;
             }
 
-            void Push(const K& priority)
+            // Same, but only reads the smallest key if it comes before the one priority already holds, and returns
+            // false otherwise
+            bool TryPeekBefore(K& priority)
             {
-                this->Wait();
-                uint32_t new_level = this->GenerateRandomLevel();
-                SPtr new_node(new KVNode<K, V>(priority, new_level));
-                std::vector<SPtr> predecessors(this->max_level + 1);
-                std::vector<SPtr> successors(this->max_level + 1);
-
-                while (true)
+                Guard guard(this->reclamation);
+                SPtr first = this->PeekFirst(guard);
+                if (!first || !this->Less(first->GetPriority(), priority))
                 {
-                    this->FindLastOfPriority(priority, predecessors, successors);
-                    for (uint32_t level = 0; level < new_level; ++level)
-                    {
-                        new_node->SetNext(level, successors[level]);
-                    }
-                    if (!predecessors[0]->CompareExchange(0, successors[0], new_node))
-                    {
-                        continue;
-                    }
-                    for (uint32_t level = 1; level < new_level; ++level)
-                    {
-                        while (true)
-                        {
-                            if (predecessors[level]->CompareExchange(level, successors[level], new_node))
-                            {
-                                break;
-                            }
-                            this->FindLastOfPriority(priority, predecessors, successors);
-                        }
-                    }
-                    break;
+                    return false;
                 }
-                new_node->SetDoneInserting();
-                this->size++;
+                priority = first->GetPriority();
+                return true;
             }
 
-            void Push(const K& priority, const V& data)
+            // Reads the smallest key and copies out its value, without removing them, returns false if the queue is
+            // empty
+            bool TryPeek(K& priority, V& data)
             {
-                this->Wait();
-                uint32_t new_level = this->GenerateRandomLevel();
-                SPtr new_node(new KVNode<K, V>(priority, data, new_level));
-                std::vector<SPtr> predecessors(this->max_level + 1);
-                std::vector<SPtr> successors(this->max_level + 1);
-
+                Guard guard(this->reclamation);
                 while (true)
                 {
-                    this->FindLastOfPriority(priority, predecessors, successors);
-                    for (uint32_t level = 0; level < new_level; ++level)
-                    {
-                        new_node->SetNext(level, successors[level]);
-                    }
-                    if (!predecessors[0]->CompareExchange(0, successors[0], new_node))
+                    SPtr first = this->PeekFirst(guard);
+                    if (!first)
                     {
-                        continue;
+                        return false;
                     }
-                    for (uint32_t level = 1; level < new_level; ++level)
+                    // Popped while we were at it, the next one is the smallest now
+                    if (first->PeekData(data))
                     {
-                        while (true)
-                        {
-                            if (predecessors[level]->CompareExchange(level, successors[level], new_node))
-                            {
-                                break;
-                            }
-                            this->FindLastOfPriority(priority, predecessors, successors);
-                        }
+                        priority = first->GetPriority();
+                        return true;
                     }
-                    break;
                 }
-                new_node->SetDoneInserting();
-                this->size++;
             }
 
+            // Pops the smallest key and moves out its value, returns false only if the queue was empty. Losing it to
+            // another pop makes it try the next one, and keys still being pushed are passed over, they count as
+            // pushed once their push returns.
             bool TryPop(K& priority, V& data)
             {
-                SPtr successor;
-                SPtr first = this->FindFirst();
-
+                Guard guard(this->reclamation);
+                SPtr first = this->TryClaimFirst(guard);
                 if (!first)
                 {
                     return false;
                 }
-                if (first->IsInserting())
-                {
-                    return false;
-                }
+                priority = first->GetPriority();
+                data = first->TakeData();
+                return true;
+            }
 
-                for (uint32_t level = first->GetLevel() - 1; level >= 1; --level)
+            // Same, but makes a single attempt and says why it failed, so callers can back off on Contended
+            PopStatus TryPopOnce(K& priority, V& data)
+            {
+                Guard guard(this->reclamation);
+                SPtr first = nullptr;
+                PopStatus status = this->TryClaimFirstOnce(guard, first);
+                if (status == PopStatus::Success)
                 {
-                    first->SetNextMark(level);
+                    priority = first->GetPriority();
+                    data = first->TakeData();
                 }
+                return status;
+            }
 
-                successor = first->GetNextPointer(0);
-                priority = first->GetPriority();
-                data = first->GetData();
-                bool success = first->TestAndSetMark(0, successor);
-                if (success)
+            // Pops up to n of the smallest keys with their values into out, as std::pair<K, V>, and returns how many.
+            // They are claimed in a single walk along the bottom level rather than a search for the first node each,
+            // and the size is updated once.
+            template<typename OutputIterator>
+            std::size_t TryPopN(OutputIterator out, std::size_t n)
+            {
+                Guard guard(this->reclamation);
+                return this->TryClaimFirstN(guard, n, [&out](const SPtr& node)
                 {
-                    this->size--;
-                    return true;
-                }
-                else
+                    *out++ = std::make_pair(node->GetPriority(), node->TakeData());
+                });
+            }
+
+            // Pops every key that does not come after bound with its value into out, as std::pair<K, V>, in order,
+            // and returns how many. Same single walk as in Queue.
+            template<typename OutputIterator>
+            std::size_t PopAllUpTo(const K& bound, OutputIterator out)
+            {
+                return this->ConsumeUpTo(bound, [&out](const K& priority, V&& data)
                 {
-                    return false;
-                }
+                    *out++ = std::make_pair(priority, std::move(data));
+                });
+            }
+
+            // Same, but hands each popped key and value to callback instead
+            template<typename Callback>
+            std::size_t ConsumeUpTo(const K& bound, Callback callback)
+            {
+                Guard guard(this->reclamation);
+                return this->TryClaimFirstWhile(guard, std::numeric_limits<std::size_t>::max(),
+                                                [this, &bound](const SPtr& node)
+                                                {
+                                                    return !this->Less(bound, node->GetPriority());
+                                                },
+                                                [&callback](const SPtr& node)
+                                                {
+                                                    callback(node->GetPriority(), node->TakeData());
+                                                });
+            }
+
+            // Blocks until a key can be popped, spinning briefly and then sleeping until a push comes in
+            void Pop(K& priority, V& data)
+            {
+                Base::Block(this->consumers, [this, &priority, &data]() { return this->TryPop(priority, data); });
+            }
+
+            // Blocks until a key can be popped or timeout has passed, returns false if it passed
+            template<typename Rep, typename Period>
+            bool PopFor(K& priority, V& data, const std::chrono::duration<Rep, Period>& timeout)
+            {
+                return this->PopUntil(priority, data, std::chrono::steady_clock::now() + timeout);
             }
 
-            uint32_t GetSize() const
+            template<typename Clock, typename Duration>
+            bool PopUntil(K& priority, V& data, const std::chrono::time_point<Clock, Duration>& deadline)
             {
-                return this->size.load();
+                return Base::BlockUntil(this->consumers,
+                                        [this, &priority, &data]() { return this->TryPop(priority, data); }, deadline);
             }
 
+            // Relaxed TryPop for when consumers threads pop at once and strict order does not matter. Instead of the
+            // smallest key it returns one of the first 2 * consumers * log2(consumers) keys on average. Single pops
+            // can land further out and there is no hard bound, see SkipList::TryClaimSprayed for measured ranks.
+            bool TryPopRelaxed(K& priority, V& data, uint32_t consumers)
+            {
+                Guard guard(this->reclamation);
+                SPtr node = this->TryClaimSprayed(guard, consumers);
+                if (!node)
+                {
+                    return false;
+                }
+                priority = node->GetPriority();
+                data = node->TakeData();
+                return true;
+            }
+
+            // Safe to call while other threads push and pop, see SkipList::ForEachNode
             std::string ToString(bool all_levels = false)
             {
                 static_assert(is_printable<K>::value, "Key type must be printable");
                 static_assert(is_printable<V>::value, "Value type must be printable");
+                Guard guard(this->reclamation);
                 std::stringstream ss;
-                uint32_t max = all_levels? this->max_level : 0;
+                uint32_t max = all_levels? this->GetMaxLevel() : 0;
                 for (uint32_t level = 0; level <= max; ++level)
                 {
                     if (all_levels)
@@ -620,27 +574,37 @@ namespace CSLPQ
                         ss << "Queue: \n";
                     }
 
-                    bool marked = false;
-                    SPtr node;
-                    SPtr nnode;
-                    std::tie(node, marked) = this->head->GetNextPointerAndMark(level);
-                    while (node)
+                    std::stringstream keys;
+                    this->ForEachNode(guard, level, [&keys](const SPtr& node, bool marked)
                     {
-                        std::tie(nnode, marked) = node->GetNextPointerAndMark(level);
-                        if (!marked)
-                        {
-                            ss << "\tKey: " << node->GetPriority() << ", Value: " << node->GetData() << "\n";
-                        }
-                        else
-                        {
-                            ss << "\tKey: " << node->GetPriority() << ", Value: " << node->GetData() << " (Marked)\n";
-                        }
-                        node = nnode;
-                    }
+                        keys << "\tKey: " << node->GetPriority() << ", Value: " << node->GetData()
+                             << (marked ? " (Marked)\n" : "\n");
+                    },
+                    [&keys]() { keys.str(""); });
+                    ss << keys.str();
                 }
                 return ss.str();
             }
     };
+
+    // The same queues with their height fixed at compile time, max_level may be left out of the constructor
+    template<typename K, uint32_t MaxLevel, typename R = SharedReclamation, typename A = DefaultAllocator,
+             typename Compare = std::less<K>, typename Count = ExactCount, typename Prefix = NoPrefix>
+    using FixedQueue = Queue<K, R, A, MaxLevel, Compare, Count, Prefix>;
+
+    template<typename K, typename V, uint32_t MaxLevel, typename R = SharedReclamation, typename A = DefaultAllocator,
+             typename Compare = std::less<K>, typename Count = ExactCount, typename Prefix = NoPrefix>
+    using FixedKVQueue = KVQueue<K, V, R, A, MaxLevel, Compare, Count, Prefix>;
+
+    // The same queues with the comparator right after the key and value types, so ordering them differently does not
+    // take spelling out every default before it
+    template<typename K, typename Compare, typename R = SharedReclamation, typename A = DefaultAllocator,
+             uint32_t MaxLevel = 0, typename Count = ExactCount, typename Prefix = NoPrefix>
+    using OrderedQueue = Queue<K, R, A, MaxLevel, Compare, Count, Prefix>;
+
+    template<typename K, typename V, typename Compare, typename R = SharedReclamation, typename A = DefaultAllocator,
+             uint32_t MaxLevel = 0, typename Count = ExactCount, typename Prefix = NoPrefix>
+    using OrderedKVQueue = KVQueue<K, V, R, A, MaxLevel, Compare, Count, Prefix>;
 }
 
 #endif // __CSLPQ_QUEUE_HPP__
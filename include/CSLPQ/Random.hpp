@@ -0,0 +1,28 @@
+#ifndef __CSLPQ_RANDOM_HPP__
+#define __CSLPQ_RANDOM_HPP__
+
+#include <cstdint>
+#include <random>
+
+namespace CSLPQ
+{
+    inline uint64_t SeedRandom()
+    {
+        std::random_device rd;
+        uint64_t seed = (uint64_t(rd()) << 32) | rd();
+        // xorshift gets stuck at 0
+        return seed ? seed : 0x9E3779B97F4A7C15ull;
+    }
+
+    // xorshift64*. Every thread has its own state, so pushes neither race on it nor share its cache line.
+    inline uint64_t NextRandom()
+    {
+        thread_local uint64_t state = SeedRandom();
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+}
+
+#endif // __CSLPQ_RANDOM_HPP__
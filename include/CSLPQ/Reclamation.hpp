@@ -0,0 +1,343 @@
+#ifndef __CSLPQ_RECLAMATION_HPP__
+#define __CSLPQ_RECLAMATION_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Pointers.hpp"
+#include "MarkablePointer.hpp"
+
+namespace CSLPQ
+{
+    // A reclamation policy decides how skiplist nodes are referenced and when they are freed. Every policy provides:
+    //  - Pointer<N> and Link<N>: the local and the atomic (markable) pointer types used for nodes.
+    //  - Parameters: tuning knobs, passed through the queue constructors.
+    //  - Guard: a scope object held for the duration of every queue operation. Next pointers are read through
+    //    Guard::Protect, and nodes that got unlinked from every level are handed to Guard::Retire.
+    //  - Create/Destroy: allocation of nodes, and freeing whatever is left in a list when its queue dies. Create takes
+    //    the level first and passes it last to the node constructor, after the other arguments.
+    //
+    // SharedReclamation is the original scheme, split reference counted jss::shared_ptr everywhere. Nothing needs
+    // to be retired since the last reference frees a node, but every pointer read costs two 16 byte CASes.
+    class SharedReclamation
+    {
+        public:
+            template<typename N>
+            using Pointer = jss::shared_ptr<N>;
+
+            template<typename N>
+            using Link = jss::markable_atomic_shared_ptr<N>;
+
+            struct Parameters
+            {
+            };
+
+            class Guard
+            {
+                public:
+                    explicit Guard(SharedReclamation&)
+                    {
+                    }
+
+                    Guard(const Guard&) = delete;
+                    Guard& operator=(const Guard&) = delete;
+
+                    template<typename N>
+                    std::pair<Pointer<N>, bool> Protect(uint32_t, const Pointer<N>& node, int level)
+                    {
+                        return node->GetNextPointerAndMark(level);
+                    }
+
+                    template<typename N>
+                    void Publish(uint32_t, const Pointer<N>&)
+                    {
+                    }
+
+                    template<typename N>
+                    void Retire(const Pointer<N>&)
+                    {
+                    }
+            };
+
+            SharedReclamation(uint32_t, const Parameters& = Parameters())
+            {
+            }
+
+            template<typename N, typename... Args>
+            static Pointer<N> Create(int level, Args&&... args)
+            {
+                return Pointer<N>(new (level) N(std::forward<Args>(args)..., level));
+            }
+
+            template<typename N>
+            static void Destroy(const Pointer<N>&, uint32_t)
+            {
+                // Dropping the head reference cascades, the delayed deleter keeps that from recursing
+            }
+    };
+
+    // SharedReclamation with the links packed into 8 bytes, see jss::tagged_markable_atomic_shared_ptr. Same
+    // reference counting, but mark checks are plain loads and every other link operation an 8 byte atomic instead
+    // of a cmpxchg16b. Needs 48 bit user space addresses.
+    class TaggedSharedReclamation : public SharedReclamation
+    {
+        public:
+            template<typename N>
+            using Link = jss::tagged_markable_atomic_shared_ptr<N>;
+
+            TaggedSharedReclamation(uint32_t slots, const Parameters& parameters = Parameters()) :
+                                    SharedReclamation(slots, parameters)
+            {
+            }
+    };
+
+    // A node that was unlinked from every level, waiting until no thread can still be looking at it.
+    struct Retired
+    {
+        void* pointer;
+        void (*deleter)(void*);
+        uint64_t epoch;
+
+        Retired(void* pointer, void (*deleter)(void*), uint64_t epoch = 0) : pointer(pointer), deleter(deleter),
+                epoch(epoch)
+        {
+        }
+
+        void Free() const
+        {
+            this->deleter(this->pointer);
+        }
+    };
+
+    template<typename N>
+    void DeleteNode(void* node)
+    {
+        delete static_cast<N*>(node);
+    }
+
+    // Frees every node still reachable from head. A node is deleted once every level it is still linked at has been
+    // walked, so nodes that are linked at several levels are freed exactly once.
+    template<typename N>
+    void DestroyNodes(N* head, uint32_t max_level)
+    {
+        if (!head)
+        {
+            return;
+        }
+        for (int64_t level = max_level; level >= 0; --level)
+        {
+            N* node = head->GetNextPointer(level);
+            while (node)
+            {
+                N* next = node->GetNextPointer(level);
+                if (node->ReleaseLink())
+                {
+                    delete node;
+                }
+                node = next;
+            }
+        }
+        delete head;
+    }
+
+    // Base of the per thread state kept by the pointer based reclamation domains.
+    struct ThreadRecord
+    {
+        std::atomic<bool> in_use;
+        ThreadRecord* next;
+
+        ThreadRecord() : in_use(true), next(nullptr)
+        {
+        }
+    };
+
+    // The set of live domains. Threads only consult it when they exit, to know which of the records they hold can
+    // still be handed back. Domain ids are never reused, so a stale id can never match a newer domain.
+    class DomainRegistry
+    {
+        private:
+            static std::mutex& GetMutex()
+            {
+                static std::mutex mutex;
+                return mutex;
+            }
+
+            static std::set<uint64_t>& GetDomains()
+            {
+                static std::set<uint64_t> domains;
+                return domains;
+            }
+
+        public:
+            static uint64_t Register()
+            {
+                static std::atomic<uint64_t> next_id(1);
+                uint64_t id = next_id++;
+                std::lock_guard<std::mutex> lock(GetMutex());
+                GetDomains().insert(id);
+                return id;
+            }
+
+            static void Unregister(uint64_t id)
+            {
+                std::lock_guard<std::mutex> lock(GetMutex());
+                GetDomains().erase(id);
+            }
+
+            static void RemoveDead(std::vector<std::pair<uint64_t, ThreadRecord*>>& records)
+            {
+                std::lock_guard<std::mutex> lock(GetMutex());
+                std::vector<std::pair<uint64_t, ThreadRecord*>> alive;
+                for (const auto& record : records)
+                {
+                    if (GetDomains().count(record.first))
+                    {
+                        alive.emplace_back(record);
+                    }
+                }
+                records.swap(alive);
+            }
+
+            template<typename F>
+            static void ForEachAlive(const std::vector<std::pair<uint64_t, ThreadRecord*>>& records, F release)
+            {
+                std::lock_guard<std::mutex> lock(GetMutex());
+                for (const auto& record : records)
+                {
+                    if (GetDomains().count(record.first))
+                    {
+                        release(record.second);
+                    }
+                }
+            }
+    };
+
+    // Lock-free list of the thread records of one domain. Records are only ever added, a thread acquires one the
+    // first time it touches the domain and gives it back when it exits. Whoever picks it up next inherits whatever
+    // it still had retired.
+    template<typename Record>
+    class RecordList
+    {
+        private:
+            struct Bindings
+            {
+                uint64_t last_id;
+                Record* last_record;
+                std::vector<std::pair<uint64_t, ThreadRecord*>> records;
+
+                Bindings() : last_id(0), last_record(nullptr)
+                {
+                }
+
+                ~Bindings()
+                {
+                    DomainRegistry::ForEachAlive(this->records, [](ThreadRecord* record)
+                    {
+                        static_cast<Record*>(record)->Release();
+                        record->in_use.store(false);
+                    });
+                }
+            };
+
+            static Bindings& GetBindings()
+            {
+                thread_local Bindings bindings;
+                return bindings;
+            }
+
+            uint64_t id;
+            std::atomic<Record*> head;
+
+            template<typename... Args>
+            Record* Acquire(Args&&... args)
+            {
+                for (Record* record = this->head.load(); record; record = static_cast<Record*>(record->next))
+                {
+                    bool in_use = false;
+                    if (!record->in_use.load() && record->in_use.compare_exchange_strong(in_use, true))
+                    {
+                        return record;
+                    }
+                }
+                Record* record = new Record(std::forward<Args>(args)...);
+                Record* old_head = this->head.load();
+                do
+                {
+                    record->next = old_head;
+                }
+                while (!this->head.compare_exchange_weak(old_head, record));
+                return record;
+            }
+
+        public:
+            RecordList() : id(DomainRegistry::Register()), head(nullptr)
+            {
+            }
+
+            RecordList(const RecordList&) = delete;
+
+            RecordList(RecordList&& other) noexcept : id(other.id), head(other.head.load())
+            {
+                other.id = 0;
+                other.head = nullptr;
+            }
+
+            RecordList& operator=(const RecordList&) = delete;
+
+            ~RecordList()
+            {
+                if (this->id)
+                {
+                    DomainRegistry::Unregister(this->id);
+                }
+                Record* record = this->head.load();
+                while (record)
+                {
+                    Record* next = static_cast<Record*>(record->next);
+                    delete record;
+                    record = next;
+                }
+            }
+
+            // The calling thread's record, acquired on first use.
+            template<typename... Args>
+            Record* Get(Args&&... args)
+            {
+                Bindings& bindings = GetBindings();
+                if (bindings.last_id == this->id)
+                {
+                    return bindings.last_record;
+                }
+                Record* record = nullptr;
+                for (const auto& binding : bindings.records)
+                {
+                    if (binding.first == this->id)
+                    {
+                        record = static_cast<Record*>(binding.second);
+                        break;
+                    }
+                }
+                if (!record)
+                {
+                    DomainRegistry::RemoveDead(bindings.records);
+                    record = this->Acquire(std::forward<Args>(args)...);
+                    bindings.records.emplace_back(this->id, record);
+                }
+                bindings.last_id = this->id;
+                bindings.last_record = record;
+                return record;
+            }
+
+            Record* GetHead() const
+            {
+                return this->head.load();
+            }
+    };
+}
+
+#endif // __CSLPQ_RECLAMATION_HPP__
@@ -0,0 +1,543 @@
+#ifndef __CSLPQ_UNROLLED_QUEUE_HPP__
+#define __CSLPQ_UNROLLED_QUEUE_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Concepts.hpp"
+#include "FatNode.hpp"
+#include "SkipList.hpp"
+#include "Epoch.hpp"
+#include "Hazard.hpp"
+#include "Allocator.hpp"
+
+namespace CSLPQ
+{
+    // A Queue that keeps up to BlockSize keys in every node, see FatNode. The skiplist is then BlockSize times
+    // shorter, so searches make that many fewer pointer hops, and pops take keys off the front of a block with one CAS
+    // for as many of them as they want instead of marking a node each.
+    //
+    // A push goes into the last node whose key is below it, or the head, copying its block with the key merged in and
+    // swapping the copy in. A full block is split instead: the lower half stays, and the upper half goes into a new
+    // node that is linked in right behind at level 0 in the same CAS, and then at its other levels like any insert. A
+    // node is marked deleted once a pop finds it empty, the head never is. A push takes effect at its CAS, a node
+    // still being linked is popped from like any other.
+    //
+    // Keys are copied in and out of blocks, so they must be trivially copyable, and the level 0 words only work with
+    // EpochReclamation and HazardReclamation. BlockSize is at most 16, the pop count has to fit the 4 low bits of the
+    // block address.
+    template<typename K, typename R = EpochReclamation, typename A = DefaultAllocator, uint32_t MaxLevel = 0,
+             typename Compare = std::less<K>, typename Count = ExactCount, uint32_t BlockSize = 16>
+    class UnrolledQueue : public SkipList<FatNode<K, R, A>, R, MaxLevel, Compare, Count>
+    {
+        static_assert(is_ordered_by<K, Compare>::value, "Key type must be totally ordered by Compare");
+        static_assert(std::is_trivially_copyable<K>::value && std::is_default_constructible<K>::value,
+                      "Key type must be trivially copyable and default constructible");
+        static_assert(std::is_pointer<typename R::template Pointer<int>>::value,
+                      "UnrolledQueue needs a pointer based reclamation policy");
+        static_assert(BlockSize >= 2 && BlockSize <= FatNode<K, R, A>::taken_mask + 1,
+                      "BlockSize must be between 2 and 16");
+        private:
+            typedef FatNode<K, R, A> N;
+            typedef SkipList<N, R, MaxLevel, Compare, Count> Base;
+            typedef typename Base::SPtr SPtr;
+            typedef typename Base::Guard Guard;
+            typedef typename N::Block Block;
+            typedef typename N::State State;
+
+            // Every node stands for up to BlockSize pops, so the deleted prefix is trimmed that much sooner
+            static const uint32_t node_trim_threshold = Base::trim_threshold / BlockSize ? Base::trim_threshold /
+                                                        BlockSize : 1;
+
+            uint32_t CountNotAfter(const K* keys, uint32_t count, const K& bound) const
+            {
+                return CSLPQ::CountNotAfter<Compare>(keys, count, bound, [this](const K& a, const K& b)
+                {
+                    return this->Less(a, b);
+                });
+            }
+
+            // Reads the state of node and publishes its block in slot, checking the block is still there afterwards
+            // so that it cannot have been retired in between
+            State ProtectState(Guard& guard, uint32_t slot, const SPtr& node)
+            {
+                State state = node->LoadState();
+                while (true)
+                {
+                    guard.Publish(slot, state.GetBlock());
+                    State check = node->LoadState();
+                    if (check.block == state.block)
+                    {
+                        return check;
+                    }
+                    state = check;
+                }
+            }
+
+            // Puts priority into the last node whose key is below it. If hinted, predecessors and successors hold the
+            // search of an earlier push of a smaller or equal key under the same guard, hinted says on return whether
+            // they still can be used that way.
+            void PushKey(Guard& guard, const K& priority, SPtr* predecessors, SPtr* successors, bool& hinted)
+            {
+                K merged[BlockSize + 1];
+                while (true)
+                {
+                    this->FindLastOfPriority(guard, priority, predecessors, successors, hinted);
+                    hinted = true;
+                    SPtr target = predecessors[0];
+                    // Rolling slots are free until the next search
+                    State state = this->ProtectState(guard, 0, target);
+                    if (state.IsMarked() || state.GetNext() != successors[0])
+                    {
+                        continue;
+                    }
+
+                    Block* block = state.GetBlock();
+                    uint32_t count = state.GetRemaining();
+                    const K* keys = block ? block->GetKeys() + state.GetTaken() : nullptr;
+                    uint32_t position = this->CountNotAfter(keys, count, priority);
+                    std::copy(keys, keys + position, merged);
+                    merged[position] = priority;
+                    std::copy(keys + position, keys + count, merged + position + 1);
+                    ++count;
+
+                    if (count <= BlockSize)
+                    {
+                        Block* new_block = Block::Create(merged, count);
+                        if (!target->CompareExchangeState(state, State(successors[0], false, new_block, 0)))
+                        {
+                            delete new_block;
+                            continue;
+                        }
+                        if (block)
+                        {
+                            guard.Retire(block);
+                        }
+                        return;
+                    }
+
+                    // Split, the upper half goes to a new node right behind target
+                    uint32_t half = count / 2;
+                    Block* lower = Block::Create(merged, half);
+                    SPtr new_node = R::template Create<N>(this->GenerateRandomLevel(), merged[half]);
+                    new_node->SetState(State(successors[0], false, Block::Create(merged + half, count - half), 0));
+                    if (!target->CompareExchangeState(state, State(new_node, false, lower, 0)))
+                    {
+                        delete lower;
+                        delete new_node;
+                        continue;
+                    }
+                    guard.Retire(block);
+                    this->LinkTower(guard, new_node);
+                    // LinkTower searched for another key, the predecessor slots no longer protect the hints
+                    hinted = false;
+                    return;
+                }
+            }
+
+            // Links a node split off at level 0 at the rest of its levels, the same way Insert does
+            void LinkTower(Guard& guard, const SPtr& new_node)
+            {
+                uint32_t new_level = new_node->GetLevel();
+                if (new_level > 1)
+                {
+                    SPtr predecessors[Base::level_limit];
+                    SPtr successors[Base::level_limit];
+                    const K priority = new_node->GetPriority();
+                    this->FindLastOfPriority(guard, priority, predecessors, successors);
+                    for (uint32_t level = 1; level < new_level; ++level)
+                    {
+                        while (true)
+                        {
+                            new_node->SetNext(level, successors[level]);
+                            if (predecessors[level]->CompareExchange(level, successors[level], new_node))
+                            {
+                                break;
+                            }
+                            this->FindLastOfPriority(guard, priority, predecessors, successors, true);
+                        }
+                    }
+                }
+                new_node->SetDoneInserting();
+            }
+
+            // Takes up to n keys off the front of the block of node with one CAS, or only those that do not come
+            // after bound if given, and hands them to consume. stopped is set if a key past bound was left.
+            template<typename Consume>
+            uint32_t TakeFrom(Guard& guard, const SPtr& node, std::size_t n, const K* bound, Consume& consume,
+                              bool& stopped)
+            {
+                while (true)
+                {
+                    State state = this->ProtectState(guard, this->PredecessorSlot(0), node);
+                    uint32_t remaining = state.GetRemaining();
+                    if (!remaining)
+                    {
+                        return 0;
+                    }
+                    Block* block = state.GetBlock();
+                    const K* keys = block->GetKeys() + state.GetTaken();
+                    uint32_t limit = uint32_t(std::min<std::size_t>(n, remaining));
+                    uint32_t take = bound ? this->CountNotAfter(keys, limit, *bound) : limit;
+                    stopped = take < limit;
+                    if (!take)
+                    {
+                        return 0;
+                    }
+                    bool exhausted = take == remaining;
+                    if (!node->CompareExchangeState(state, State(state.GetNext(), false, exhausted ? nullptr : block,
+                                                                 state.GetTaken() + take)))
+                    {
+                        continue;
+                    }
+                    // The block never changes, and stays protected until the guard is released
+                    for (uint32_t i = 0; i < take; ++i)
+                    {
+                        consume(keys[i]);
+                    }
+                    if (exhausted)
+                    {
+                        guard.Retire(block);
+                    }
+                    return take;
+                }
+            }
+
+            // Marks an empty node as deleted. Returns false if a push refilled it before its level 0 word got marked.
+            // Unlike TryMark, level 0 goes first so a refilled node keeps its whole tower. Until the upper levels are
+            // marked as well, searches go through the node there as through any live one.
+            bool TryMarkEmpty(const SPtr& node)
+            {
+                State state = node->LoadState();
+                while (!state.IsMarked())
+                {
+                    if (state.GetBlock())
+                    {
+                        return false;
+                    }
+                    State marked = state;
+                    marked.next |= 1;
+                    if (node->CompareExchangeState(state, marked))
+                    {
+                        break;
+                    }
+                }
+                for (uint32_t level = node->GetLevel() - 1; level >= 1; --level)
+                {
+                    node->SetNextMark(level);
+                }
+                return true;
+            }
+
+            // Pops up to n keys in one walk from the head, stopping at the first key past bound if given, and marks
+            // the nodes it empties. Shaped like SkipList::TryClaimFirstWhile, the size is updated once.
+            template<typename Consume>
+            std::size_t TakeFirstWhile(Guard& guard, std::size_t n, const K* bound, Consume consume)
+            {
+                SPtr predecessor = this->head;
+                SPtr current = nullptr;
+                SPtr run = nullptr;
+                uint32_t passed = 0;
+                uint32_t prefix = 0;
+                bool stopped = false;
+
+                uint32_t current_slot = 0;
+                uint32_t run_slot = 1;
+                uint32_t spare_slot = 2;
+                uint32_t predecessor_slot = 3;
+
+                std::size_t taken = this->TakeFrom(guard, this->head, n, bound, consume, stopped);
+                bool walking = taken < n && !stopped &&
+                               this->FindNextUnmarked(guard, predecessor, 0, run, current, passed, current_slot,
+                                                      run_slot, spare_slot);
+                while (taken < n && !stopped)
+                {
+                    if (!walking)
+                    {
+                        predecessor = this->head;
+                        walking = this->FindNextUnmarked(guard, predecessor, 0, run, current, passed, current_slot,
+                                                         run_slot, spare_slot);
+                        continue;
+                    }
+                    if (!current)
+                    {
+                        break;
+                    }
+                    taken += this->TakeFrom(guard, current, n - taken, bound, consume, stopped);
+                    if (taken == n || stopped)
+                    {
+                        break;
+                    }
+                    if (current->IsInserting())
+                    {
+                        // Left linked until its push is done with it, the walk goes on from behind it
+                        if (predecessor == this->head)
+                        {
+                            prefix = passed;
+                        }
+                        predecessor = current;
+                        std::swap(predecessor_slot, current_slot);
+                        walking = this->FindNextUnmarked(guard, predecessor, 0, run, current, passed, current_slot,
+                                                         run_slot, spare_slot);
+                        continue;
+                    }
+                    if (!this->TryMarkEmpty(current))
+                    {
+                        continue;
+                    }
+                    walking = this->SkipMarked(guard, predecessor, 0, run, current, passed, current_slot, run_slot,
+                                               spare_slot);
+                }
+
+                if (taken)
+                {
+                    this->size.Sub(taken);
+                    this->producers.NotifyAll();
+                }
+                if (predecessor == this->head)
+                {
+                    prefix = passed;
+                }
+                if (prefix >= node_trim_threshold)
+                {
+                    this->TrimPrefix(guard);
+                }
+                return taken;
+            }
+
+        public:
+            // A node reaches each next level with probability level_probability. preallocate nodes are set aside
+            // for the constructing thread, if the allocator keeps a pool.
+            explicit UnrolledQueue(uint32_t max_level = MaxLevel ? MaxLevel : 4, uint32_t max_size = 0,
+                                   double level_probability = 0.5,
+                                   const typename R::Parameters& parameters = typename R::Parameters(),
+                                   uint32_t preallocate = 0, const Compare& compare = Compare()) :
+                                   Base(max_level, max_size, level_probability, parameters, preallocate, compare)
+            {
+            }
+
+            UnrolledQueue(const UnrolledQueue&) = delete;
+
+            UnrolledQueue(UnrolledQueue&& other) noexcept : Base(std::move(other))
+            {
+            }
+
+            UnrolledQueue& operator=(const UnrolledQueue&) = delete;
+
+            void Push(const K& priority)
+            {
+                this->ReserveSlot();
+                Guard guard(this->reclamation);
+                SPtr predecessors[Base::level_limit];
+                SPtr successors[Base::level_limit];
+                bool hinted = false;
+                this->PushKey(guard, priority, predecessors, successors, hinted);
+                this->consumers.Notify();
+            }
+
+            // Pushes the keys in [first, last), sorted first and pushed in increasing order under a single guard,
+            // every search starting from where the previous key went. Bounded queues push them one at a time.
+            template<typename Iterator>
+            void PushBatch(Iterator first, Iterator last)
+            {
+                std::vector<K> keys(first, last);
+                if (this->max_size)
+                {
+                    for (const K& key : keys)
+                    {
+                        this->Push(key);
+                    }
+                    return;
+                }
+                std::sort(keys.begin(), keys.end(), [this](const K& a, const K& b) { return this->Less(a, b); });
+                this->size.Add(keys.size());
+                Guard guard(this->reclamation);
+                SPtr predecessors[Base::level_limit];
+                SPtr successors[Base::level_limit];
+                bool hinted = false;
+                for (const K& key : keys)
+                {
+                    this->PushKey(guard, key, predecessors, successors, hinted);
+                }
+                this->consumers.NotifyAll();
+            }
+
+            // Push that returns false instead of waiting when a bounded queue is full
+            bool TryPush(const K& priority)
+            {
+                if (!this->TryReserveSlot())
+                {
+                    return false;
+                }
+                Guard guard(this->reclamation);
+                SPtr predecessors[Base::level_limit];
+                SPtr successors[Base::level_limit];
+                bool hinted = false;
+                this->PushKey(guard, priority, predecessors, successors, hinted);
+                this->consumers.Notify();
+                return true;
+            }
+
+            // Reads the smallest key without removing it, returns false if the queue is empty. The key may be popped
+            // by another thread by the time this returns.
+            bool TryPeek(K& priority)
+            {
+                Guard guard(this->reclamation);
+                SPtr predecessor = this->head;
+                SPtr current = this->head;
+                SPtr run = nullptr;
+                uint32_t passed;
+
+                uint32_t current_slot = 0;
+                uint32_t run_slot = 1;
+                uint32_t spare_slot = 2;
+                uint32_t predecessor_slot = 3;
+
+                while (current)
+                {
+                    State state = this->ProtectState(guard, this->PredecessorSlot(0), current);
+                    if (state.GetRemaining())
+                    {
+                        priority = state.GetBlock()->GetKeys()[state.GetTaken()];
+                        return true;
+                    }
+                    if (current != this->head)
+                    {
+                        predecessor = current;
+                        std::swap(predecessor_slot, current_slot);
+                    }
+                    if (!this->FindNextUnmarked(guard, predecessor, 0, run, current, passed, current_slot, run_slot,
+                                                spare_slot))
+                    {
+                        predecessor = this->head;
+                        current = this->head;
+                    }
+                }
+                return false;
+            }
+
+            // Pops the smallest key, returns false only if the queue was empty
+            bool TryPop(K& priority)
+            {
+                Guard guard(this->reclamation);
+                return this->TakeFirstWhile(guard, 1, nullptr, [&priority](const K& key) { priority = key; });
+            }
+
+            // Pops up to n of the smallest keys into out and returns how many, taking as many as it can from every
+            // node with one CAS
+            template<typename OutputIterator>
+            std::size_t TryPopN(OutputIterator out, std::size_t n)
+            {
+                Guard guard(this->reclamation);
+                return this->TakeFirstWhile(guard, n, nullptr, [&out](const K& key) { *out++ = key; });
+            }
+
+            // Pops every key that does not come after bound into out, in order, and returns how many
+            template<typename OutputIterator>
+            std::size_t PopAllUpTo(const K& bound, OutputIterator out)
+            {
+                return this->ConsumeUpTo(bound, [&out](const K& priority)
+                {
+                    *out++ = priority;
+                });
+            }
+
+            // Same, but hands each popped key to callback instead
+            template<typename Callback>
+            std::size_t ConsumeUpTo(const K& bound, Callback callback)
+            {
+                Guard guard(this->reclamation);
+                return this->TakeFirstWhile(guard, std::numeric_limits<std::size_t>::max(), &bound,
+                                            [&callback](const K& key) { callback(key); });
+            }
+
+            // Blocks until a key can be popped, spinning briefly and then sleeping until a push comes in
+            void Pop(K& priority)
+            {
+                Base::Block(this->consumers, [this, &priority]() { return this->TryPop(priority); });
+            }
+
+            // Blocks until a key can be popped or timeout has passed, returns false if it passed
+            template<typename Rep, typename Period>
+            bool PopFor(K& priority, const std::chrono::duration<Rep, Period>& timeout)
+            {
+                return this->PopUntil(priority, std::chrono::steady_clock::now() + timeout);
+            }
+
+            template<typename Clock, typename Duration>
+            bool PopUntil(K& priority, const std::chrono::time_point<Clock, Duration>& deadline)
+            {
+                return Base::BlockUntil(this->consumers, [this, &priority]() { return this->TryPop(priority); },
+                                        deadline);
+            }
+
+            // Level 0 lists the keys, the head's first, the levels above list the keys of the nodes. Safe to call while
+            // other threads push and pop, see SkipList::ForEachNode.
+            std::string ToString(bool all_levels = false)
+            {
+                static_assert(is_printable<K>::value, "Key type must be printable");
+                Guard guard(this->reclamation);
+                std::stringstream ss;
+                uint32_t max = all_levels? this->GetMaxLevel() : 0;
+                for (uint32_t level = 0; level <= max; ++level)
+                {
+                    if (all_levels)
+                    {
+                        ss << "Queue at level " << level << ":\n";
+                    }
+                    else
+                    {
+                        ss << "Queue: \n";
+                    }
+
+                    std::stringstream keys;
+                    auto print_block = [this, &guard, &keys](const SPtr& node)
+                    {
+                        State state = this->ProtectState(guard, this->PredecessorSlot(0), node);
+                        const K* block = state.GetBlock() ? state.GetBlock()->GetKeys() : nullptr;
+                        for (uint32_t i = state.GetTaken(); i < state.GetTaken() + state.GetRemaining(); ++i)
+                        {
+                            keys << "\tKey: " << block[i] << "\n";
+                        }
+                    };
+                    auto start = [this, level, &keys, &print_block]()
+                    {
+                        keys.str("");
+                        if (!level)
+                        {
+                            print_block(this->head);
+                        }
+                    };
+                    start();
+                    this->ForEachNode(guard, level, [level, &keys, &print_block](const SPtr& node, bool marked)
+                    {
+                        if (level)
+                        {
+                            keys << "\tKey: " << node->GetPriority() << (marked ? " (Marked)\n" : "\n");
+                        }
+                        else
+                        {
+                            print_block(node);
+                        }
+                    },
+                    start);
+                    ss << keys.str();
+                }
+                return ss.str();
+            }
+    };
+
+    // The same queue with the comparator right after the key type, see OrderedQueue
+    template<typename K, typename Compare, typename R = EpochReclamation, typename A = DefaultAllocator,
+             uint32_t MaxLevel = 0, typename Count = ExactCount, uint32_t BlockSize = 16>
+    using OrderedUnrolledQueue = UnrolledQueue<K, R, A, MaxLevel, Compare, Count, BlockSize>;
+}
+
+#endif // __CSLPQ_UNROLLED_QUEUE_HPP__
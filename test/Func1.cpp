@@ -7,8 +7,8 @@ int main()
     CSLPQ::KVQueue<uint64_t, void*> queue(8);
     while (true)
     {
-        uint64_t key;
-        void* value;
+        uint64_t key = 0;
+        void* value = nullptr;
         if (queue.TryPop(key, value))
         {
             std::cerr << "FAILURE: Read " << key << ": " << value << " from empty queue" << std::endl;
@@ -53,8 +53,8 @@ int main()
 
     while (true)
     {
-        uint64_t key;
-        void* value;
+        uint64_t key = 0;
+        void* value = nullptr;
         if (queue.TryPop(key, value))
         {
             std::cout << key << ": " << value << std::endl;
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+
+#include "CSLPQ/UnrolledQueue.hpp"
+
+#define COUNT 100000
+
+// Keys in order with duplicates, across enough splits to build a tall list, whichever way they are pushed and popped
+template<typename Q, typename K>
+bool check_order(const std::vector<K>& keys, const std::vector<K>& sorted)
+{
+    Q queue(8);
+    queue.PushBatch(keys.begin(), keys.begin() + keys.size() / 2);
+    for (uint64_t i = keys.size() / 2; i < keys.size(); i++)
+    {
+        queue.Push(keys[i]);
+    }
+    if (queue.GetSize() != keys.size())
+    {
+        std::cerr << "FAILURE: Size " << queue.GetSize() << " instead of " << keys.size() << std::endl;
+        return false;
+    }
+    K peeked;
+    if (!queue.TryPeek(peeked) || peeked != sorted[0])
+    {
+        std::cerr << "FAILURE: Peeked " << peeked << " instead of " << sorted[0] << std::endl;
+        return false;
+    }
+
+    std::vector<K> popped;
+    queue.PopAllUpTo(sorted[sorted.size() / 4], std::back_inserter(popped));
+    if (popped.empty() || !(popped.back() == sorted[sorted.size() / 4]))
+    {
+        std::cerr << "FAILURE: PopAllUpTo stopped early" << std::endl;
+        return false;
+    }
+    while (queue.TryPopN(std::back_inserter(popped), 37))
+    {
+        K key;
+        if (queue.TryPop(key))
+        {
+            popped.push_back(key);
+        }
+    }
+    if (popped != sorted || queue.GetSize() || queue.TryPeek(peeked))
+    {
+        std::cerr << "FAILURE: Popped " << popped.size() << " keys out of order" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    // Every key pushed three times
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        keys.emplace_back(i / 3);
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+    std::vector<uint64_t> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+
+    if (!check_order<CSLPQ::UnrolledQueue<uint64_t>>(keys, sorted) ||
+        !check_order<CSLPQ::UnrolledQueue<uint64_t, CSLPQ::HazardReclamation, CSLPQ::PoolAllocator>>(keys, sorted) ||
+        !check_order<CSLPQ::UnrolledQueue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0,
+                                          std::less<uint64_t>, CSLPQ::ExactCount, 2>>(keys, sorted) ||
+        !check_order<CSLPQ::UnrolledQueue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0,
+                                          std::less<uint64_t>, CSLPQ::ExactCount, 5>>(keys, sorted))
+    {
+        return 1;
+    }
+
+    // The other orders and key types the vector search knows, and one it does not
+    std::vector<double> doubles;
+    std::vector<int64_t> signed_keys;
+    std::vector<uint32_t> narrow_keys;
+    for (uint64_t key : keys)
+    {
+        doubles.emplace_back(double(key) / 7 - 1000);
+        signed_keys.emplace_back(int64_t(key) - COUNT / 6);
+        narrow_keys.emplace_back(uint32_t(key));
+    }
+    std::vector<double> sorted_doubles(doubles);
+    std::sort(sorted_doubles.begin(), sorted_doubles.end(), std::greater<double>());
+    std::vector<int64_t> sorted_signed(signed_keys);
+    std::sort(sorted_signed.begin(), sorted_signed.end());
+    std::vector<uint32_t> sorted_narrow(narrow_keys);
+    std::sort(sorted_narrow.begin(), sorted_narrow.end(), std::greater<uint32_t>());
+    if (!check_order<CSLPQ::OrderedUnrolledQueue<double, std::greater<double>>>(doubles, sorted_doubles) ||
+        !check_order<CSLPQ::UnrolledQueue<int64_t>>(signed_keys, sorted_signed) ||
+        !check_order<CSLPQ::OrderedUnrolledQueue<uint32_t, std::greater<uint32_t>>>(narrow_keys, sorted_narrow))
+    {
+        return 1;
+    }
+
+    // The vector search agrees with the plain one on every count of every block size
+    for (uint32_t count = 0; count <= 16; count++)
+    {
+        std::vector<uint64_t> block;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            block.emplace_back(uint64_t(1) << 63 | i / 2);
+        }
+        for (uint32_t i = 0; i <= count; i++)
+        {
+            uint64_t bound = uint64_t(1) << 63 | i / 2;
+            uint32_t expected = std::upper_bound(block.begin(), block.end(), bound) - block.begin();
+            uint32_t found = CSLPQ::CountNotAfter<std::less<uint64_t>>(block.data(), count, bound,
+                                                                       std::less<uint64_t>());
+            if (found != expected)
+            {
+                std::cerr << "FAILURE: Counted " << found << " keys up to " << bound << " instead of " << expected
+                          << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // Level 0 lists the keys
+    {
+        CSLPQ::UnrolledQueue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0, std::less<uint64_t>,
+                             CSLPQ::ExactCount, 4> queue(4);
+        for (uint64_t i = 10; i > 0; i--)
+        {
+            queue.Push(i);
+        }
+        std::string expected = "Queue: \n";
+        for (uint64_t i = 1; i <= 10; i++)
+        {
+            expected += "\tKey: " + std::to_string(i) + "\n";
+        }
+        if (queue.ToString() != expected)
+        {
+            std::cerr << "FAILURE: ToString gave " << queue.ToString() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 20000
+
+// Orders (priority, id) pairs by priority alone
+struct PriorityPrefix
+{
+    static const bool enabled = true;
+
+    static uint64_t Get(const std::pair<uint64_t, uint64_t>& key)
+    {
+        return key.first;
+    }
+};
+
+int main()
+{
+    // A prefix takes 8 bytes in the node, no prefix takes none
+    static_assert(std::is_empty<CSLPQ::PrefixField<CSLPQ::NoPrefix>>::value, "NoPrefix adds to the node size");
+    static_assert(sizeof(CSLPQ::Node<std::string, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator,
+                                     CSLPQ::StringPrefix>) ==
+                  sizeof(CSLPQ::Node<std::string, CSLPQ::EpochReclamation>) + sizeof(uint64_t),
+                  "Prefix takes more than its 8 bytes");
+
+    // Strings that tie on their first 8 characters, or are shorter than that, or differ early on
+    std::vector<std::string> keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        std::string key = std::to_string(i * 7919 % COUNT);
+        switch (i % 4)
+        {
+            case 0:
+                keys.emplace_back("job/queue/" + key);
+                break;
+            case 1:
+                keys.emplace_back("job/" + key);
+                break;
+            case 2:
+                keys.emplace_back(key);
+                break;
+            default:
+                keys.emplace_back(std::string("job/queue") + char(i % 3));
+                break;
+        }
+    }
+    std::vector<std::string> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+
+    CSLPQ::Queue<std::string, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0, std::less<std::string>,
+                 CSLPQ::ExactCount, CSLPQ::StringPrefix> queue(8);
+    queue.PushBatch(keys.begin(), keys.begin() + COUNT / 2);
+    for (uint64_t i = COUNT / 2; i < COUNT; i++)
+    {
+        queue.Push(keys[i]);
+    }
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        std::string key;
+        if (!queue.TryPop(key) || key != sorted[i])
+        {
+            std::cerr << "FAILURE: Read " << key << " instead of " << sorted[i] << std::endl;
+            return 1;
+        }
+    }
+
+    // A prefix of part of the key, values stay with their keys
+    CSLPQ::KVQueue<std::pair<uint64_t, uint64_t>, uint64_t, CSLPQ::HazardReclamation, CSLPQ::DefaultAllocator, 0,
+                   std::less<std::pair<uint64_t, uint64_t>>, CSLPQ::ExactCount, PriorityPrefix> kvqueue(8);
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        uint64_t id = i * 7919 % COUNT;
+        kvqueue.Push(std::make_pair(id % 10, id), id);
+    }
+    std::pair<uint64_t, uint64_t> last(0, 0);
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        std::pair<uint64_t, uint64_t> key;
+        uint64_t value = 0;
+        if (!kvqueue.TryPop(key, value) || key < last || value != key.second)
+        {
+            std::cerr << "FAILURE: Read " << key.first << ", " << key.second << ": " << value << " out of order"
+                      << std::endl;
+            return 1;
+        }
+        last = key;
+    }
+
+    return 0;
+}
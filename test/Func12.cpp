@@ -0,0 +1,75 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 10000
+
+// Peeks read what the next pop takes, and leave it there
+int main()
+{
+    {
+        CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation> queue(8);
+        CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation> kvqueue(8);
+        uint64_t key = 0;
+        uint64_t value = 0;
+        if (queue.TryPeek(key) || kvqueue.TryPeek(key) || kvqueue.TryPeek(key, value))
+        {
+            std::cerr << "FAILURE: Peeked " << key << " in an empty queue" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        // Every key twice, with different values
+        keys.emplace_back(i / 2);
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+
+    {
+        CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation> queue(8);
+        for (uint64_t key : keys)
+        {
+            queue.Push(key);
+        }
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            uint64_t peeked = 0;
+            uint64_t again = 0;
+            uint64_t key = 0;
+            if (!queue.TryPeek(peeked) || !queue.TryPeek(again) || queue.GetSize() != COUNT - i ||
+                !queue.TryPop(key) || peeked != again || key != peeked || key != i / 2)
+            {
+                std::cerr << "FAILURE: Peeked " << peeked << " and " << again << " but read " << key << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    {
+        CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation> queue(8);
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            queue.Push(keys[i], i);
+        }
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            uint64_t peeked_key = 0;
+            uint64_t peeked_value = 0;
+            uint64_t key = 0;
+            uint64_t value = 0;
+            if (!queue.TryPeek(peeked_key, peeked_value) || !queue.TryPop(key, value) || key != peeked_key ||
+                value != peeked_value || keys[value] != key)
+            {
+                std::cerr << "FAILURE: Peeked " << peeked_key << ": " << peeked_value << " but read " << key << ": "
+                          << value << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include <iostream>
+#include <thread>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100
+
+// Global pooled queues free their nodes during static destruction, after the main thread let go of its pools. Frees
+// then have to go by the block alone, a lookup of the thread's pools reads freed memory, which AddressSanitizer
+// reports. Two node types, so there are two pools, and some blocks freed by another thread, so they wait on the
+// remote stacks.
+CSLPQ::Queue<uint64_t, CSLPQ::SharedReclamation, CSLPQ::PoolAllocator> queue(8);
+CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator> kvqueue(8);
+
+int main()
+{
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        queue.Push(i);
+        kvqueue.Push(i, i);
+    }
+    bool failed = false;
+    std::thread([&failed]()
+    {
+        for (uint64_t i = 0; i < COUNT / 2; i++)
+        {
+            uint64_t key = 0;
+            uint64_t value = 0;
+            if (!queue.TryPop(key) || !kvqueue.TryPop(key, value) || key != i || value != i)
+            {
+                failed = true;
+            }
+        }
+    }).join();
+    if (failed || queue.GetSize() != COUNT / 2 || kvqueue.GetSize() != COUNT / 2)
+    {
+        std::cerr << "FAILURE: Pops from the global queues went wrong" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+
+#include "CSLPQ/Queue.hpp"
+
+#include "Helpers.hpp"
+
+#define COUNT 1000
+#define POPS 400
+
+// Popped nodes pile up behind the head as a deleted prefix until a pop walks over trim_threshold of them, and then
+// get unlinked from every level at once. After every pop the prefix has to hold exactly the latest pops, no longer
+// than trim_threshold at any level, and only the pop that walked over trim_threshold of them may cut it, down to
+// nothing at every level. Values count their instances, so trimmed nodes have to be freed right away under
+// SharedReclamation.
+
+class TrimmedQueue : public CSLPQ::KVQueue<uint64_t, Tracked>
+{
+    public:
+        TrimmedQueue() : CSLPQ::KVQueue<uint64_t, Tracked>(8)
+        {
+        }
+
+        static uint32_t GetTrimThreshold()
+        {
+            return trim_threshold;
+        }
+
+        // Marked nodes right after the head at every level, their keys at level 0, only while the queue is quiet
+        std::vector<uint64_t> GetPrefix(std::vector<uint32_t>& lengths) const
+        {
+            std::vector<uint64_t> keys;
+            lengths.assign(this->GetMaxLevel() + 1, 0);
+            for (uint32_t level = 0; level <= this->GetMaxLevel(); ++level)
+            {
+                for (auto node = this->head->GetNextPointer(level); node && node->IsNextMarked(level);
+                     node = node->GetNextPointer(level))
+                {
+                    lengths[level]++;
+                    if (level == 0)
+                    {
+                        keys.push_back(node->GetPriority());
+                    }
+                }
+            }
+            return keys;
+        }
+};
+
+int main()
+{
+    TrimmedQueue queue;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        queue.Push(i, Tracked(i));
+    }
+
+    const uint32_t threshold = TrimmedQueue::GetTrimThreshold();
+    uint32_t last = 0;
+    uint64_t trims = 0;
+    for (uint64_t i = 0; i < POPS; i++)
+    {
+        uint64_t key = 0;
+        Tracked value;
+        if (!queue.TryPop(key, value) || key != i || value.id != i)
+        {
+            std::cerr << "FAILURE: Read " << key << ": " << value.id << " instead of " << i << std::endl;
+            return 1;
+        }
+
+        std::vector<uint32_t> lengths;
+        std::vector<uint64_t> keys = queue.GetPrefix(lengths);
+        // The pop that walked over trim_threshold nodes unlinks them along with its own
+        uint32_t expected = last >= threshold ? 0 : last + 1;
+        if (lengths[0] != expected)
+        {
+            std::cerr << "FAILURE: Deleted prefix of " << lengths[0] << " nodes after " << i + 1 << " pops, expected "
+                      << expected << std::endl;
+            return 1;
+        }
+        for (uint32_t level = 1; level < lengths.size(); ++level)
+        {
+            if (lengths[level] > lengths[0] || (!expected && lengths[level]))
+            {
+                std::cerr << "FAILURE: Deleted prefix of " << lengths[level] << " nodes at level " << level
+                          << " against " << lengths[0] << " at level 0" << std::endl;
+                return 1;
+            }
+        }
+        for (uint32_t j = 0; j < keys.size(); ++j)
+        {
+            if (keys[j] != i + 1 - keys.size() + j)
+            {
+                std::cerr << "FAILURE: Deleted prefix holds " << keys[j] << " after " << i + 1 << " pops" << std::endl;
+                return 1;
+            }
+        }
+        // Left in the queue, left in the prefix, the head's and the one just read
+        if (Tracked::live != int64_t(COUNT - i - 1 + lengths[0] + 2))
+        {
+            std::cerr << "FAILURE: " << Tracked::live << " values live after " << i + 1 << " pops with a prefix of "
+                      << lengths[0] << std::endl;
+            return 1;
+        }
+        trims += !expected;
+        last = lengths[0];
+    }
+    if (trims != POPS / (threshold + 1))
+    {
+        std::cerr << "FAILURE: Trimmed " << trims << " times in " << POPS << " pops" << std::endl;
+        return 1;
+    }
+    return 0;
+}
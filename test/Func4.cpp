@@ -0,0 +1,53 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 10000
+
+int main()
+{
+    CSLPQ::FixedKVQueue<uint64_t, uint64_t, 6, CSLPQ::EpochReclamation> queue;
+
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        keys.emplace_back(i);
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+    for (uint64_t key : keys)
+    {
+        queue.Push(key, key * 2);
+    }
+
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        uint64_t key = 0;
+        uint64_t value = 0;
+        if (!queue.TryPop(key, value) || key != i || value != i * 2)
+        {
+            std::cerr << "FAILURE: Expected " << i << " but read " << key << ": " << value << std::endl;
+            return 1;
+        }
+    }
+    if (queue.GetSize())
+    {
+        std::cerr << "FAILURE: Queue not empty" << std::endl;
+        return 1;
+    }
+
+    // The height is fixed, asking for another one is an error
+    try
+    {
+        CSLPQ::FixedQueue<uint64_t, 6, CSLPQ::EpochReclamation> other(4);
+        std::cerr << "FAILURE: Mismatched max_level accepted" << std::endl;
+        return 1;
+    }
+    catch (const std::invalid_argument&)
+    {
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100000
+#define CAPACITY 100
+
+int main()
+{
+    CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation> queue(4, CAPACITY);
+
+    // Exactly CAPACITY pushes fit
+    for (uint64_t i = 0; i < CAPACITY; i++)
+    {
+        if (!queue.TryPush(i, i))
+        {
+            std::cerr << "FAILURE: TryPush failed at " << i << " below capacity" << std::endl;
+            return 1;
+        }
+    }
+    if (queue.TryPush(CAPACITY, CAPACITY) || queue.GetSize() != CAPACITY)
+    {
+        std::cerr << "FAILURE: TryPush succeeded on a full queue" << std::endl;
+        return 1;
+    }
+
+    // Producers block on the full queue until the consumer makes room
+    std::atomic<bool> failed(false);
+    std::thread producers[2];
+    for (uint64_t p = 0; p < 2; p++)
+    {
+        producers[p] = std::thread([&queue, p]()
+        {
+            for (uint64_t i = CAPACITY + p; i < COUNT; i += 2)
+            {
+                queue.Push(i, i);
+            }
+        });
+    }
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        if (queue.GetSize() > CAPACITY)
+        {
+            std::cerr << "FAILURE: Queue grew to " << queue.GetSize() << std::endl;
+            failed = true;
+            break;
+        }
+        uint64_t key = 0;
+        uint64_t value = 0;
+        queue.Pop(key, value);
+        if (key != value)
+        {
+            std::cerr << "FAILURE: Read " << key << ": " << value << std::endl;
+            failed = true;
+            break;
+        }
+    }
+    if (failed)
+    {
+        // The producers may be stuck on the full queue
+        for (uint64_t p = 0; p < 2; p++)
+        {
+            producers[p].detach();
+        }
+        return 1;
+    }
+    for (uint64_t p = 0; p < 2; p++)
+    {
+        producers[p].join();
+    }
+    if (queue.GetSize())
+    {
+        std::cerr << "FAILURE: Queue not empty" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100000
+#define STEP 37
+
+int main()
+{
+    // Event timestamps, with a few events on each
+    std::vector<uint64_t> times;
+    std::map<uint64_t, uint64_t> times_ref;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        times.emplace_back(i / 4);
+        times_ref[i / 4]++;
+    }
+    std::random_shuffle(times.begin(), times.end());
+
+    CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation> queue(8);
+    for (uint64_t i = 0; i < COUNT / 2; i++)
+    {
+        queue.Push(times[i], times[i]);
+    }
+
+    // Advance time, every step pops exactly the events up to now, and schedules more of them as it goes
+    uint64_t next = COUNT / 2;
+    uint64_t popped = 0;
+    for (uint64_t now = 0; popped != COUNT; now += STEP)
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> events;
+        if (now % 2)
+        {
+            queue.PopAllUpTo(now, std::back_inserter(events));
+        }
+        else
+        {
+            queue.ConsumeUpTo(now, [&events](uint64_t time, uint64_t data)
+            {
+                events.emplace_back(time, data);
+            });
+        }
+        for (uint64_t i = 0; i < events.size(); i++)
+        {
+            if (events[i].first > now || events[i].first != events[i].second ||
+                (i && events[i].first < events[i - 1].first))
+            {
+                std::cerr << "FAILURE: Read " << events[i].first << ": " << events[i].second << " at " << now
+                          << std::endl;
+                return 1;
+            }
+            if (!times_ref[events[i].first]--)
+            {
+                std::cerr << "FAILURE: Read " << events[i].first << " too many times" << std::endl;
+                return 1;
+            }
+        }
+        popped += events.size();
+
+        // Everything due was popped
+        uint64_t first = 0;
+        if (queue.TryPeek(first) && first <= now)
+        {
+            std::cerr << "FAILURE: " << first << " left behind at " << now << std::endl;
+            return 1;
+        }
+
+        // Only events still in the future get scheduled
+        for (uint64_t i = 0; i < STEP && next < COUNT; i++, next++)
+        {
+            if (times[next] <= now)
+            {
+                times_ref[times[next]]--;
+                popped++;
+                continue;
+            }
+            queue.Push(times[next], times[next]);
+        }
+    }
+
+    if (queue.GetSize())
+    {
+        std::cerr << "FAILURE: Queue not empty" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iterator>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100000
+
+int main()
+{
+    // Move only values go in by move or in place, and come out by move
+    {
+        CSLPQ::KVQueue<uint64_t, std::unique_ptr<uint64_t>, CSLPQ::EpochReclamation> queue(8);
+        for (uint64_t i = 0; i < COUNT; i += 2)
+        {
+            std::unique_ptr<uint64_t> value(new uint64_t(i));
+            queue.Push(i, std::move(value));
+            queue.Emplace(i + 1, new uint64_t(i + 1));
+        }
+        std::vector<std::pair<uint64_t, std::unique_ptr<uint64_t>>> popped;
+        queue.TryPopN(std::back_inserter(popped), 10);
+        queue.PopAllUpTo(19, std::back_inserter(popped));
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            uint64_t key = 0;
+            std::unique_ptr<uint64_t> value;
+            if (i < popped.size())
+            {
+                key = popped[i].first;
+                value = std::move(popped[i].second);
+            }
+            else if (!queue.TryPop(key, value))
+            {
+                std::cerr << "FAILURE: Queue empty at " << i << std::endl;
+                return 1;
+            }
+            if (key != i || !value || *value != i)
+            {
+                std::cerr << "FAILURE: Read " << key << " instead of " << i << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // Values peeked at while other threads pop them stay intact, strings long enough to live on the heap
+    {
+        CSLPQ::KVQueue<uint64_t, std::string, CSLPQ::EpochReclamation> queue(8);
+        const std::string suffix(64, 'x');
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            queue.Push(i, std::to_string(i) + suffix);
+        }
+        std::atomic<uint64_t> count(0);
+        std::atomic<bool> failed(false);
+        std::vector<std::thread> threads;
+        for (uint64_t t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&queue, &count, &failed, &suffix, t]()
+            {
+                while (count != COUNT && !failed)
+                {
+                    uint64_t key = 0;
+                    std::string value;
+                    bool popping = t % 2;
+                    bool found = popping ? queue.TryPop(key, value) : queue.TryPeek(key, value);
+                    if (found && value != std::to_string(key) + suffix)
+                    {
+                        std::cerr << "FAILURE: Read " << key << ": " << value << std::endl;
+                        failed = true;
+                    }
+                    if (found && popping)
+                    {
+                        count++;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        if (failed)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+
+#include "CSLPQ/Queue.hpp"
+#include "CSLPQ/MultiQueue.hpp"
+
+#define COUNT 100000
+
+// Orders (deadline, id) pairs by deadline only, leaving ties in push order
+struct ByDeadline
+{
+    bool operator()(const std::pair<uint64_t, uint64_t>& a, const std::pair<uint64_t, uint64_t>& b) const
+    {
+        return a.first < b.first;
+    }
+};
+
+// Comparators a queue cannot derive from, kept as members instead
+struct Descending final
+{
+    bool operator()(const uint64_t& a, const uint64_t& b) const
+    {
+        return a > b;
+    }
+};
+
+bool Ascending(const uint64_t& a, const uint64_t& b)
+{
+    return a < b;
+}
+
+// Pops every key and checks it is the i-th one, ordered by descending or not
+template<typename Q>
+bool drain(Q& queue, bool descending)
+{
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        uint64_t key = 0;
+        uint64_t expected = descending ? COUNT - 1 - i : i;
+        if (!queue.TryPop(key) || key != expected)
+        {
+            std::cerr << "FAILURE: Read " << key << " instead of " << expected << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    // Comparators take no space
+    static_assert(sizeof(CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0,
+                                      std::greater<uint64_t>>) ==
+                  sizeof(CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation>), "Comparator adds to the queue size");
+    // Ordered aliases only move the comparator forward
+    static_assert(std::is_same<CSLPQ::OrderedQueue<uint64_t, std::greater<uint64_t>>,
+                               CSLPQ::Queue<uint64_t, CSLPQ::SharedReclamation, CSLPQ::DefaultAllocator, 0,
+                                            std::greater<uint64_t>>>::value, "OrderedQueue is a different queue");
+    static_assert(std::is_same<CSLPQ::OrderedMultiQueue<uint64_t, uint64_t, std::greater<uint64_t>,
+                                                        CSLPQ::EpochReclamation>,
+                               CSLPQ::MultiQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator,
+                                                 std::greater<uint64_t>>>::value,
+                  "OrderedMultiQueue is a different queue");
+
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        keys.emplace_back(i);
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+
+    // A max queue, filled both ways
+    {
+        CSLPQ::OrderedQueue<uint64_t, std::greater<uint64_t>, CSLPQ::EpochReclamation> queue(8);
+        for (uint64_t i = 0; i < COUNT / 2; i++)
+        {
+            queue.Push(keys[i]);
+        }
+        queue.PushBatch(keys.begin() + COUNT / 2, keys.end());
+        std::vector<uint64_t> popped;
+        queue.PopAllUpTo(COUNT - 10, std::back_inserter(popped));
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            uint64_t key = 0;
+            if (i < popped.size())
+            {
+                key = popped[i];
+            }
+            else if (!queue.TryPop(key))
+            {
+                std::cerr << "FAILURE: Queue empty at " << i << std::endl;
+                return 1;
+            }
+            if (key != COUNT - 1 - i)
+            {
+                std::cerr << "FAILURE: Read " << key << " instead of " << COUNT - 1 - i << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // A final functor and a function pointer
+    {
+        CSLPQ::OrderedQueue<uint64_t, Descending, CSLPQ::EpochReclamation> queue(8);
+        queue.PushBatch(keys.begin(), keys.end());
+        if (!drain(queue, true))
+        {
+            return 1;
+        }
+    }
+    {
+        typedef bool (*Function)(const uint64_t&, const uint64_t&);
+        CSLPQ::OrderedQueue<uint64_t, Function, CSLPQ::HazardReclamation> queue(
+            8, 0, 0.5, CSLPQ::HazardReclamation::Parameters(), 0, Ascending);
+        queue.PushBatch(keys.begin(), keys.end());
+        if (!drain(queue, false))
+        {
+            return 1;
+        }
+    }
+
+    // Composite keys ordered on one field
+    {
+        CSLPQ::OrderedKVQueue<std::pair<uint64_t, uint64_t>, uint64_t, ByDeadline, CSLPQ::HazardReclamation> queue(8);
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            queue.Push(std::make_pair(keys[i] / 4, i), i);
+        }
+        std::pair<uint64_t, uint64_t> last(0, 0);
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            std::pair<uint64_t, uint64_t> key;
+            uint64_t value = 0;
+            if (!queue.TryPop(key, value) || key.second != value || key.first < last.first)
+            {
+                std::cerr << "FAILURE: Read " << key.first << ", " << key.second << ": " << value << std::endl;
+                return 1;
+            }
+            last = key;
+        }
+    }
+
+    // Shards agree on the order
+    {
+        CSLPQ::OrderedMultiQueue<uint64_t, uint64_t, std::greater<uint64_t>, CSLPQ::EpochReclamation> queue(1, 1);
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            queue.Push(keys[i], keys[i]);
+        }
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            uint64_t key = 0;
+            uint64_t value = 0;
+            if (!queue.TryPop(key, value) || key != value)
+            {
+                std::cerr << "FAILURE: Read " << key << ": " << value << std::endl;
+                return 1;
+            }
+            // The two shards drain from the top, so early pops come from the top of the key range
+            if (i < COUNT / 100 && key < COUNT / 2)
+            {
+                std::cerr << "FAILURE: Read " << key << " among the first pops" << std::endl;
+                return 1;
+            }
+            total += key;
+        }
+        if (total != uint64_t(COUNT) * (COUNT - 1) / 2)
+        {
+            std::cerr << "FAILURE: Keys lost" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100000
+#define THREADS 8
+
+// Every thread pushes its share and pops half of it, sizes have to add up once they are done
+template<typename Q>
+bool check_count(uint64_t expected)
+{
+    Q queue(8);
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([&queue, t]()
+        {
+            for (uint64_t i = t; i < COUNT; i += THREADS)
+            {
+                queue.Push(i, i);
+            }
+            uint64_t key = 0;
+            uint64_t value = 0;
+            for (uint64_t i = t; i < COUNT / 2; i += THREADS)
+            {
+                while (!queue.TryPop(key, value));
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    if (queue.GetSize() != expected)
+    {
+        std::cerr << "FAILURE: Size " << queue.GetSize() << " instead of " << expected << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    typedef CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation> ExactQueue;
+    typedef CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0,
+                           std::less<uint64_t>, CSLPQ::ShardedCount<4>> ShardedQueue;
+    typedef CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0,
+                           std::less<uint64_t>, CSLPQ::NoCount> UncountedQueue;
+
+    // More threads than stripes, so some share one
+    if (!check_count<ExactQueue>(COUNT / 2) || !check_count<ShardedQueue>(COUNT / 2) ||
+        !check_count<UncountedQueue>(0))
+    {
+        return 1;
+    }
+
+    // Bounds need an exact count
+    try
+    {
+        ShardedQueue queue(8, 100);
+        std::cerr << "FAILURE: Bounded queue without an exact count" << std::endl;
+        return 1;
+    }
+    catch (const std::invalid_argument&)
+    {
+    }
+
+    return 0;
+}
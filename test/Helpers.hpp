@@ -0,0 +1,76 @@
+#ifndef __CSLPQ_TEST_HELPERS_HPP__
+#define __CSLPQ_TEST_HELPERS_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Helpers shared by the tests. Every test is its own executable, so defining statics here is fine.
+
+// Counts live instances, so we can tell every node got freed exactly once
+struct Tracked
+{
+    static std::atomic<int64_t> live;
+    uint64_t id;
+
+    Tracked() : id(0)
+    {
+        live++;
+    }
+
+    Tracked(uint64_t id) : id(id)
+    {
+        live++;
+    }
+
+    Tracked(const Tracked& other) : id(other.id)
+    {
+        live++;
+    }
+
+    Tracked& operator=(const Tracked& other) = default;
+
+    ~Tracked()
+    {
+        live--;
+    }
+};
+
+std::atomic<int64_t> Tracked::live(0);
+
+// Keys 0 to count - 1 left, counted with a Fenwick tree so ranks come cheap
+class Remaining
+{
+    private:
+        std::vector<int64_t> tree;
+
+    public:
+        explicit Remaining(uint64_t count) : tree(count + 1, 0)
+        {
+            for (uint64_t key = 0; key < count; key++)
+            {
+                this->Update(key, 1);
+            }
+        }
+
+        void Update(uint64_t key, int64_t delta)
+        {
+            for (uint64_t i = key + 1; i < this->tree.size(); i += i & -i)
+            {
+                this->tree[i] += delta;
+            }
+        }
+
+        // Keys left below key
+        uint64_t Rank(uint64_t key) const
+        {
+            int64_t rank = 0;
+            for (uint64_t i = key; i > 0; i -= i & -i)
+            {
+                rank += this->tree[i];
+            }
+            return rank;
+        }
+};
+
+#endif // __CSLPQ_TEST_HELPERS_HPP__
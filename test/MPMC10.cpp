@@ -0,0 +1,127 @@
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100000
+#define BATCH 32
+
+std::vector<std::vector<uint64_t>> keys;
+std::set<uint64_t> keys_ref;
+std::mutex keys_ref_mutex;
+pthread_barrier_t barrier;
+std::atomic<uint64_t> count;
+std::atomic<bool> failed;
+
+void insert(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation>& queue, std::vector<uint64_t>& local_keys)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < COUNT / 10; i++)
+    {
+        queue.Push(local_keys[i], local_keys[i]);
+    }
+}
+
+void remove_(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation>& queue)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> popped;
+    while (count != COUNT && !failed)
+    {
+        popped.clear();
+        count += queue.TryPopN(std::back_inserter(popped), BATCH);
+        std::lock_guard<std::mutex> lock(keys_ref_mutex);
+        for (const std::pair<uint64_t, uint64_t>& item : popped)
+        {
+            if (keys_ref.find(item.first) == keys_ref.end() || item.second != item.first)
+            {
+                std::cerr << "FAILURE: Read " << item.first << ": " << item.second << " which has already been removed"
+                          << std::endl;
+                failed = true;
+                return;
+            }
+            keys_ref.erase(item.first);
+        }
+    }
+}
+
+int main()
+{
+    count = 0;
+    failed = false;
+    pthread_barrier_init(&barrier, NULL, 10);
+
+    // First, fill the keys and ref
+    std::vector<uint64_t> full_keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        full_keys.emplace_back(i);
+        keys_ref.insert(i);
+    }
+
+    // Shuffle the keys
+    std::random_shuffle(full_keys.begin(), full_keys.end());
+
+    // Batches come out in order, the last one short
+    {
+        CSLPQ::Queue<uint64_t, CSLPQ::HazardReclamation> queue(8);
+        for (uint64_t i = 0; i < COUNT / 10; i++)
+        {
+            queue.Push(full_keys[i]);
+        }
+        std::vector<uint64_t> sorted(full_keys.begin(), full_keys.begin() + COUNT / 10);
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<uint64_t> popped;
+        while (queue.TryPopN(std::back_inserter(popped), BATCH + 1))
+        {
+        }
+        if (popped != sorted || queue.GetSize())
+        {
+            std::cerr << "FAILURE: TryPopN returned " << popped.size() << " keys out of order" << std::endl;
+            return 1;
+        }
+    }
+
+    // Split among threads
+    keys.resize(10);
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        keys[i] = std::vector<uint64_t>(full_keys.begin() + i * COUNT / 10, full_keys.begin() + (i + 1) * COUNT / 10);
+    }
+
+    CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation> queue(8, 0, 0.5,
+                                                                       CSLPQ::HazardReclamation::Parameters(16, 4));
+
+    // Start the threads
+    std::cout << "Starting threads" << std::endl;
+    std::vector<std::thread> ts;
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ts.emplace_back(remove_, std::ref(queue));
+    }
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ts.emplace_back(insert, std::ref(queue), std::ref(keys[i]));
+    }
+    for (uint64_t i = 0; i < 20; i++)
+    {
+        ts[i].join();
+    }
+    if (failed)
+    {
+        return 1;
+    }
+    if (!keys_ref.empty() || queue.GetSize())
+    {
+        std::cerr << "FAILURE: " << keys_ref.size() << " keys were never read" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
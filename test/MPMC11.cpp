@@ -0,0 +1,99 @@
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <vector>
+#include <atomic>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100000
+#define THREADS 4
+
+pthread_barrier_t barrier;
+std::atomic<bool> failed;
+std::atomic<uint64_t> contended;
+
+// The queue never runs dry: it starts with COUNT keys, pushers only add to it, and the poppers take COUNT in all. Any
+// pop coming back empty is a spurious failure.
+void pop(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation>& queue, bool once)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < COUNT / THREADS && !failed; i++)
+    {
+        uint64_t key = 0;
+        uint64_t value = 0;
+        bool popped;
+        if (once)
+        {
+            CSLPQ::PopStatus status;
+            while ((status = queue.TryPopOnce(key, value)) == CSLPQ::PopStatus::Contended)
+            {
+                contended++;
+            }
+            popped = status == CSLPQ::PopStatus::Success;
+        }
+        else
+        {
+            popped = queue.TryPop(key, value);
+        }
+        if (!popped || key != value)
+        {
+            std::cerr << "FAILURE: Pop " << i << " failed on a queue that is not empty" << std::endl;
+            failed = true;
+        }
+    }
+}
+
+void push(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation>& queue, uint64_t first)
+{
+    pthread_barrier_wait(&barrier);
+    // Small keys, so pops keep running into nodes still being inserted
+    for (uint64_t i = first; i < COUNT && !failed; i += 2)
+    {
+        queue.Push(i % 64, i % 64);
+    }
+}
+
+int main()
+{
+    failed = false;
+    contended = 0;
+    pthread_barrier_init(&barrier, NULL, THREADS + 2);
+
+    CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation> queue(8);
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        queue.Push(i, i);
+    }
+
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back(pop, std::ref(queue), t % 2);
+    }
+    for (uint64_t t = 0; t < 2; t++)
+    {
+        threads.emplace_back(push, std::ref(queue), t);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    if (failed)
+    {
+        return 1;
+    }
+    std::cout << contended << " contended attempts" << std::endl;
+
+    // Once it does run dry it says so
+    uint64_t key = 0;
+    uint64_t value = 0;
+    while (queue.TryPop(key, value));
+    if (queue.TryPopOnce(key, value) != CSLPQ::PopStatus::Empty || queue.GetSize())
+    {
+        std::cerr << "FAILURE: Queue not empty" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
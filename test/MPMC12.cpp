@@ -0,0 +1,191 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#include "CSLPQ/Reclamation.hpp"
+
+#define ROUNDS 50
+#define SWAPS 100000
+#define LOADS 100000
+#define READERS 2
+#define WRITERS 2
+
+// The tagged link packs pointer, alias index, mark and access count into 8 bytes. Every round writers swap one link
+// between two pointers while readers load it, counting themselves in and out of the same word, until a marker marks
+// it. Pointers and the mark have to come back as stored, the mark has to freeze the pointer, and no access count
+// may be lost or leaked into the reference counts.
+
+// Counts live instances, so we can tell the pointers got freed exactly once
+struct Payload
+{
+    static std::atomic<int64_t> live;
+    uint64_t id;
+
+    Payload(uint64_t id) : id(id)
+    {
+        live++;
+    }
+
+    ~Payload()
+    {
+        live--;
+    }
+};
+
+std::atomic<int64_t> Payload::live(0);
+
+typedef jss::shared_ptr<Payload> Pointer;
+typedef CSLPQ::TaggedSharedReclamation::Link<Payload> Link;
+
+static_assert(sizeof(Link) == 8, "Tagged links must fit in 8 bytes");
+static_assert(sizeof(jss::tagged_markable_atomic_shared_ptr<Payload>) == sizeof(uint64_t),
+              "Tagged links must fit in 8 bytes");
+
+std::atomic<uint64_t> swaps;
+std::atomic<uint64_t> loads;
+std::atomic<bool> done;
+std::atomic<bool> failed;
+
+bool IsEither(const Pointer& pointer, const Pointer& a, const Pointer& b)
+{
+    return (pointer == a && pointer->id == 0) || (pointer == b && pointer->id == 1);
+}
+
+void read(Link& link, const Pointer& a, const Pointer& b)
+{
+    Pointer frozen;
+    while (!done && !failed)
+    {
+        std::pair<Pointer, bool> current = link.load_marked();
+        Pointer loaded = link.load();
+        if (!IsEither(current.first, a, b) || !IsEither(loaded, a, b))
+        {
+            std::cerr << "FAILURE: Loaded a pointer that was never stored" << std::endl;
+            failed = true;
+        }
+        else if (frozen && (!current.second || current.first != frozen || loaded != frozen))
+        {
+            std::cerr << "FAILURE: Link changed after it was marked" << std::endl;
+            failed = true;
+        }
+        else if (current.second)
+        {
+            frozen = current.first;
+        }
+        loads++;
+    }
+}
+
+void swap(Link& link, const Pointer& a, const Pointer& b)
+{
+    Pointer expected = link.load();
+    while (!failed)
+    {
+        bool marked = link.is_marked();
+        if (!IsEither(expected, a, b))
+        {
+            std::cerr << "FAILURE: CAS refreshed expected with a pointer that was never stored" << std::endl;
+            failed = true;
+            return;
+        }
+        if (link.compare_exchange_weak(expected, expected == a ? b : a))
+        {
+            if (marked)
+            {
+                std::cerr << "FAILURE: Swapped a marked link" << std::endl;
+                failed = true;
+                return;
+            }
+            swaps++;
+            expected = expected == a ? b : a;
+        }
+        else if (marked)
+        {
+            return;
+        }
+    }
+}
+
+void mark(Link& link)
+{
+    // Long enough for the threads to be interleaved even on a single core
+    while ((swaps < SWAPS || loads < LOADS) && !failed)
+    {
+        std::this_thread::yield();
+    }
+    Pointer expected = link.load();
+    if (!link.test_and_set_mark(expected) || link.test_and_set_mark(expected))
+    {
+        std::cerr << "FAILURE: Mark was not set exactly once" << std::endl;
+        failed = true;
+    }
+}
+
+int main()
+{
+    failed = false;
+    {
+        Pointer a = jss::make_shared<Payload>(0);
+        Pointer b = jss::make_shared<Payload>(1);
+        for (uint64_t round = 0; round < ROUNDS && !failed; round++)
+        {
+            swaps = 0;
+            loads = 0;
+            done = false;
+            {
+                Link link(a);
+                std::vector<std::thread> writers;
+                for (uint64_t i = 0; i < WRITERS; i++)
+                {
+                    writers.emplace_back(swap, std::ref(link), std::cref(a), std::cref(b));
+                }
+                writers.emplace_back(mark, std::ref(link));
+                std::vector<std::thread> readers;
+                for (uint64_t i = 0; i < READERS; i++)
+                {
+                    readers.emplace_back(read, std::ref(link), std::cref(a), std::cref(b));
+                }
+                for (std::thread& thread : writers)
+                {
+                    thread.join();
+                }
+                done = true;
+                for (std::thread& thread : readers)
+                {
+                    thread.join();
+                }
+                if (failed)
+                {
+                    return 1;
+                }
+
+                // Every successful swap flips the link, and the mark stopped them
+                const Pointer& last = swaps % 2 ? b : a;
+                {
+                    std::pair<Pointer, bool> current = link.load_marked();
+                    if (!current.second || current.first != last)
+                    {
+                        std::cerr << "FAILURE: Link ended at " << current.first->id << " after " << swaps << " swaps"
+                                  << std::endl;
+                        return 1;
+                    }
+                }
+            }
+
+            // Access counts an A, B, A swap left on the link or the headers cancel out once it is gone
+            if (a.use_count() != 1 || b.use_count() != 1)
+            {
+                std::cerr << "FAILURE: Use counts " << a.use_count() << " and " << b.use_count()
+                          << " after the link was destroyed" << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (Payload::live != 0)
+    {
+        std::cerr << "FAILURE: " << Payload::live << " payloads were leaked or freed twice" << std::endl;
+        return 1;
+    }
+    return 0;
+}
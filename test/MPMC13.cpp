@@ -0,0 +1,130 @@
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <algorithm>
+#include <iterator>
+
+#include "CSLPQ/UnrolledQueue.hpp"
+
+#define COUNT 100000
+#define BATCH 32
+
+std::vector<std::vector<uint64_t>> keys;
+std::set<uint64_t> keys_ref;
+std::mutex keys_ref_mutex;
+pthread_barrier_t barrier;
+std::atomic<uint64_t> count;
+std::atomic<bool> failed;
+
+template<typename Q>
+void insert(Q& queue, std::vector<uint64_t>& local_keys)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < COUNT / 10; i++)
+    {
+        queue.Push(local_keys[i]);
+    }
+}
+
+// Every other thread pops one at a time, the rest in batches
+template<typename Q>
+void remove_(Q& queue, bool batched)
+{
+    std::vector<uint64_t> popped;
+    while (count != COUNT && !failed)
+    {
+        popped.clear();
+        if (batched)
+        {
+            count += queue.TryPopN(std::back_inserter(popped), BATCH);
+        }
+        else
+        {
+            uint64_t key;
+            if (queue.TryPop(key))
+            {
+                popped.push_back(key);
+                count++;
+            }
+        }
+        std::lock_guard<std::mutex> lock(keys_ref_mutex);
+        for (uint64_t key : popped)
+        {
+            if (keys_ref.find(key) == keys_ref.end())
+            {
+                std::cerr << "FAILURE: Read " << key << " which has already been removed" << std::endl;
+                failed = true;
+                return;
+            }
+            keys_ref.erase(key);
+        }
+    }
+}
+
+template<typename Q>
+bool run(Q& queue, const std::vector<uint64_t>& full_keys)
+{
+    count = 0;
+    failed = false;
+    keys_ref = std::set<uint64_t>(full_keys.begin(), full_keys.end());
+    pthread_barrier_init(&barrier, NULL, 10);
+
+    std::cout << "Starting threads" << std::endl;
+    std::vector<std::thread> ts;
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ts.emplace_back(remove_<Q>, std::ref(queue), i % 2 == 0);
+    }
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ts.emplace_back(insert<Q>, std::ref(queue), std::ref(keys[i]));
+    }
+    for (uint64_t i = 0; i < 20; i++)
+    {
+        ts[i].join();
+    }
+    pthread_barrier_destroy(&barrier);
+    if (failed)
+    {
+        return false;
+    }
+    if (!keys_ref.empty() || queue.GetSize())
+    {
+        std::cerr << "FAILURE: " << keys_ref.size() << " keys were never read" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    // First, fill the keys
+    std::vector<uint64_t> full_keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        full_keys.emplace_back(i);
+    }
+
+    // Shuffle the keys
+    std::random_shuffle(full_keys.begin(), full_keys.end());
+
+    // Split among threads
+    keys.resize(10);
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        keys[i] = std::vector<uint64_t>(full_keys.begin() + i * COUNT / 10, full_keys.begin() + (i + 1) * COUNT / 10);
+    }
+
+    CSLPQ::UnrolledQueue<uint64_t, CSLPQ::EpochReclamation> epoch_queue(8);
+    CSLPQ::UnrolledQueue<uint64_t, CSLPQ::HazardReclamation, CSLPQ::PoolAllocator, 0, std::less<uint64_t>,
+                         CSLPQ::ExactCount, 4> hazard_queue(8, 0, 0.5, CSLPQ::HazardReclamation::Parameters(16, 4));
+    if (!run(epoch_queue, full_keys) || !run(hazard_queue, full_keys))
+    {
+        return 1;
+    }
+
+    return 0;
+}
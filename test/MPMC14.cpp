@@ -0,0 +1,91 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <set>
+
+#include "CSLPQ/UnrolledQueue.hpp"
+
+#define COUNT 2000
+
+// A drained node can be refilled by a push before the pop that emptied it marks it deleted. The pop then has to
+// leave it as it was, tower included. Drains up to one key at a time, and while the key at the bound is handed out,
+// after its node was emptied and before the node gets marked, another thread pushes a key just past the bound into
+// it. The drain stops at that key, and every node still live at level 0 has to be linked and unmarked at all of its
+// levels.
+
+typedef CSLPQ::UnrolledQueue<uint64_t, CSLPQ::EpochReclamation, CSLPQ::DefaultAllocator, 0, std::less<uint64_t>,
+                             CSLPQ::ExactCount, 4> Unrolled;
+
+class TowerQueue : public Unrolled
+{
+    public:
+        TowerQueue() : Unrolled(8, 0, 0.75)
+        {
+        }
+
+        // Levels of live nodes that are marked or cut out of their level, only while the queue is quiet
+        uint64_t CountCutLevels() const
+        {
+            std::vector<std::set<const void*>> linked(this->GetMaxLevel() + 1);
+            for (uint32_t level = 1; level <= this->GetMaxLevel(); ++level)
+            {
+                for (auto node = this->head->GetNextPointer(level); node; node = node->GetNextPointer(level))
+                {
+                    linked[level].insert(&*node);
+                }
+            }
+            uint64_t cut = 0;
+            for (auto node = this->head->GetNextPointer(0); node; node = node->GetNextPointer(0))
+            {
+                if (node->IsNextMarked(0))
+                {
+                    continue;
+                }
+                for (int level = 1; level < node->GetLevel(); ++level)
+                {
+                    if (node->IsNextMarked(level) || !linked[level].count(&*node))
+                    {
+                        cut++;
+                    }
+                }
+            }
+            return cut;
+        }
+};
+
+int main()
+{
+    TowerQueue queue;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        queue.Push(i * 10);
+    }
+
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        uint64_t bound = i * 10;
+        std::vector<uint64_t> popped;
+        queue.ConsumeUpTo(bound, [&](uint64_t key)
+        {
+            popped.push_back(key);
+            if (key == bound)
+            {
+                std::thread([&queue, bound]() { queue.Push(bound + 1); }).join();
+            }
+        });
+        // The key past the last bound, then this one
+        if (popped.size() != (i ? 2 : 1) || popped.back() != bound || (i && popped[0] != bound - 9))
+        {
+            std::cerr << "FAILURE: Popped " << popped.size() << " keys up to " << bound << std::endl;
+            return 1;
+        }
+        uint64_t cut = queue.CountCutLevels();
+        if (cut)
+        {
+            std::cerr << "FAILURE: " << cut << " levels of live nodes were cut out after popping " << bound
+                      << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 20000
+#define POPPERS 3
+
+// ToString racing pops under HazardReclamation, retiring often so nodes get freed right behind the dump. Every key a
+// dump lists must be one that was pushed, and the walk must not read freed nodes, which AddressSanitizer reports.
+
+typedef CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation> Queue;
+
+std::atomic<bool> done;
+std::atomic<bool> failed;
+
+void pop(Queue& queue)
+{
+    uint64_t key;
+    uint64_t value;
+    while (queue.TryPop(key, value))
+    {
+        if (key != value)
+        {
+            std::cerr << "FAILURE: Read " << key << ": " << value << std::endl;
+            failed = true;
+        }
+    }
+}
+
+void dump(Queue& queue, bool all_levels)
+{
+    while (!done)
+    {
+        std::stringstream ss(queue.ToString(all_levels));
+        std::string line;
+        while (std::getline(ss, line))
+        {
+            uint64_t key = 0;
+            uint64_t value = 0;
+            if (std::sscanf(line.c_str(), "\tKey: %lu, Value: %lu", &key, &value) == 2 &&
+                (key >= COUNT || key != value))
+            {
+                std::cerr << "FAILURE: Dumped " << line << std::endl;
+                failed = true;
+            }
+        }
+    }
+}
+
+int main()
+{
+    done = false;
+    failed = false;
+    for (bool all_levels : {false, true})
+    {
+        Queue queue(8, 0, 0.5, CSLPQ::HazardReclamation::Parameters(4, 1));
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            queue.Push(i, i);
+        }
+        done = false;
+        std::thread dumper(dump, std::ref(queue), all_levels);
+        std::vector<std::thread> poppers;
+        for (uint64_t i = 0; i < POPPERS; i++)
+        {
+            poppers.emplace_back(pop, std::ref(queue));
+        }
+        for (std::thread& popper : poppers)
+        {
+            popper.join();
+        }
+        done = true;
+        dumper.join();
+        if (failed)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
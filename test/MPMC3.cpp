@@ -0,0 +1,201 @@
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <string>
+#include <algorithm>
+
+#include "CSLPQ/Queue.hpp"
+#include "CSLPQ/MultiQueue.hpp"
+
+#include "Helpers.hpp"
+
+#define COUNT 100000
+
+// The same stress run, 10 pushers against 10 poppers with every key checked to come out exactly once, over each
+// queue configuration that changes how nodes are linked, freed or popped. Behavior specific to a configuration is
+// tested on its own, see MPMC4 and up.
+
+struct StrictPop
+{
+    template<typename Q>
+    static bool TryPop(Q& queue, uint64_t& key, Tracked& value)
+    {
+        return queue.TryPop(key, value);
+    }
+};
+
+// Relaxed pops for 10 consumers
+struct RelaxedPop
+{
+    template<typename Q>
+    static bool TryPop(Q& queue, uint64_t& key, Tracked& value)
+    {
+        return queue.TryPopRelaxed(key, value, 10);
+    }
+};
+
+std::vector<std::vector<uint64_t>> keys;
+std::set<uint64_t> keys_ref;
+std::mutex keys_ref_mutex;
+pthread_barrier_t barrier;
+std::atomic<uint64_t> pushed;
+std::atomic<uint64_t> count;
+std::atomic<bool> failed;
+
+// Strict pops that wait for every key to be in, so the poppers drain a full queue and keep trimming the deleted prefix
+// while others walk it
+struct BacklogPop
+{
+    template<typename Q>
+    static bool TryPop(Q& queue, uint64_t& key, Tracked& value)
+    {
+        return pushed == COUNT && queue.TryPop(key, value);
+    }
+};
+
+template<typename Q>
+void insert(Q& queue, std::vector<uint64_t>& local_keys)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < COUNT / 10; i++)
+    {
+        queue.Push(local_keys[i], Tracked(local_keys[i]));
+        pushed++;
+    }
+}
+
+template<typename Q, typename Pop>
+void remove_(Q& queue)
+{
+    while (count != COUNT && !failed)
+    {
+        uint64_t key;
+        Tracked value;
+        if (Pop::TryPop(queue, key, value))
+        {
+            count++;
+            keys_ref_mutex.lock();
+            if (keys_ref.find(key) == keys_ref.end() || value.id != key)
+            {
+                keys_ref_mutex.unlock();
+                std::cerr << "FAILURE: Read " << key << ": " << value.id << " which has already been removed" << std::endl;
+                failed = true;
+                return;
+            }
+            else
+            {
+                keys_ref.erase(key);
+                keys_ref_mutex.unlock();
+            }
+        }
+    }
+}
+
+template<typename Q, typename Pop, typename... Args>
+bool run(const std::string& name, Args... args)
+{
+    std::cout << "Starting threads on " << name << std::endl;
+    pushed = 0;
+    count = 0;
+    failed = false;
+    pthread_barrier_init(&barrier, NULL, 10);
+
+    // First, fill the keys and ref
+    std::vector<uint64_t> full_keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        full_keys.emplace_back(i);
+        keys_ref.insert(i);
+    }
+
+    // Shuffle the keys
+    std::random_shuffle(full_keys.begin(), full_keys.end());
+
+    // Split among threads
+    keys.resize(10);
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        keys[i] = std::vector<uint64_t>(full_keys.begin() + i * COUNT / 10, full_keys.begin() + (i + 1) * COUNT / 10);
+    }
+
+    {
+        Q queue(args...);
+
+        // Start the threads
+        std::vector<std::thread> ts;
+        for (uint64_t i = 0; i < 10; i++)
+        {
+            ts.emplace_back(remove_<Q, Pop>, std::ref(queue));
+        }
+        for (uint64_t i = 0; i < 10; i++)
+        {
+            ts.emplace_back(insert<Q>, std::ref(queue), std::ref(keys[i]));
+        }
+        for (uint64_t i = 0; i < 20; i++)
+        {
+            ts[i].join();
+        }
+        pthread_barrier_destroy(&barrier);
+        if (failed)
+        {
+            return false;
+        }
+        if (!keys_ref.empty() || queue.GetSize())
+        {
+            std::cerr << "FAILURE: " << keys_ref.size() << " keys were never read from " << name << std::endl;
+            return false;
+        }
+
+        // Leave some nodes behind for the destructor
+        for (uint64_t i = 0; i < 1000; i++)
+        {
+            queue.Push(i, Tracked(i));
+        }
+    }
+
+    if (Tracked::live != 0)
+    {
+        std::cerr << "FAILURE: " << Tracked::live << " values were leaked or freed twice by " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    if (!run<CSLPQ::KVQueue<uint64_t, Tracked, CSLPQ::EpochReclamation>, StrictPop>("Epoch", 8))
+    {
+        return 1;
+    }
+    if (!run<CSLPQ::KVQueue<uint64_t, Tracked, CSLPQ::HazardReclamation>, StrictPop>(
+             "Hazard", 8, 0, 0.5, CSLPQ::HazardReclamation::Parameters(16, 4)))
+    {
+        return 1;
+    }
+    if (!run<CSLPQ::KVQueue<uint64_t, Tracked, CSLPQ::HazardReclamation>, BacklogPop>(
+             "Backlog", 8, 0, 0.5, CSLPQ::HazardReclamation::Parameters(16, 4)))
+    {
+        return 1;
+    }
+    if (!run<CSLPQ::KVQueue<uint64_t, Tracked, CSLPQ::TaggedSharedReclamation>, StrictPop>("Tagged", 8))
+    {
+        return 1;
+    }
+    if (!run<CSLPQ::KVQueue<uint64_t, Tracked, CSLPQ::EpochReclamation, CSLPQ::PoolAllocator>, StrictPop>(
+             "Pool", 8, 0, 0.5, CSLPQ::EpochReclamation::Parameters(), 1000))
+    {
+        return 1;
+    }
+    if (!run<CSLPQ::KVQueue<uint64_t, Tracked, CSLPQ::EpochReclamation>, RelaxedPop>("Relaxed", 8))
+    {
+        return 1;
+    }
+    if (!run<CSLPQ::MultiQueue<uint64_t, Tracked, CSLPQ::EpochReclamation>, StrictPop>("Multi", 10, 2, 8))
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include "CSLPQ/Queue.hpp"
+
+#include "Helpers.hpp"
+
+#define COUNT 20000
+#define POPPERS 4
+#define MAX_LEVEL 8
+#define RETIRE_THRESHOLD 32
+
+// A reader stalls while holding a hazard on the first node, and the poppers drain the queue around it. The node it
+// holds cannot be freed, but every thread's retired list has to stay within max(retire_threshold, H + 1) regardless,
+// H being the hazard slots of all threads: the main thread, the reader and the poppers.
+
+class StalledQueue : public CSLPQ::KVQueue<uint64_t, Tracked, CSLPQ::HazardReclamation>
+{
+    public:
+        StalledQueue() : CSLPQ::KVQueue<uint64_t, Tracked, CSLPQ::HazardReclamation>(
+                         MAX_LEVEL, 0, 0.5, CSLPQ::HazardReclamation::Parameters(RETIRE_THRESHOLD, 4))
+        {
+        }
+
+        // Holds the first node until release is set, then checks it is still there to be read
+        bool Stall(std::atomic<bool>& stalled, std::atomic<bool>& release)
+        {
+            CSLPQ::HazardReclamation::Guard guard(this->reclamation);
+            auto first = this->PeekFirst(guard);
+            uint64_t key = first->GetPriority();
+            stalled = true;
+            while (!release)
+            {
+                std::this_thread::yield();
+            }
+            return first->GetPriority() == key;
+        }
+
+        std::size_t GetRetiredCount()
+        {
+            return this->reclamation.GetRetiredCount();
+        }
+};
+
+std::atomic<uint64_t> popped;
+std::atomic<bool> failed;
+
+void pop(StalledQueue& queue, std::size_t bound)
+{
+    uint64_t key = 0;
+    Tracked value;
+    while (queue.TryPop(key, value))
+    {
+        popped++;
+        if (value.id != key)
+        {
+            std::cerr << "FAILURE: Read " << key << ": " << value.id << std::endl;
+            failed = true;
+        }
+        if (queue.GetRetiredCount() > bound)
+        {
+            std::cerr << "FAILURE: " << queue.GetRetiredCount() << " retired nodes with a bound of " << bound
+                      << std::endl;
+            failed = true;
+            return;
+        }
+    }
+}
+
+int main()
+{
+    popped = 0;
+    failed = false;
+    const std::size_t hazards = (POPPERS + 2) * (4 + 2 * (MAX_LEVEL + 1));
+    const std::size_t bound = std::max<std::size_t>(RETIRE_THRESHOLD, hazards + 1);
+
+    {
+        StalledQueue queue;
+        for (uint64_t i = 0; i < COUNT; i++)
+        {
+            queue.Push(i, Tracked(i));
+        }
+
+        std::atomic<bool> stalled(false);
+        std::atomic<bool> release(false);
+        bool intact = false;
+        std::thread reader([&]() { intact = queue.Stall(stalled, release); });
+        while (!stalled)
+        {
+            std::this_thread::yield();
+        }
+
+        std::vector<std::thread> poppers;
+        for (uint64_t i = 0; i < POPPERS; i++)
+        {
+            poppers.emplace_back(pop, std::ref(queue), bound);
+        }
+        for (std::thread& popper : poppers)
+        {
+            popper.join();
+        }
+        release = true;
+        reader.join();
+
+        if (failed)
+        {
+            return 1;
+        }
+        if (popped != COUNT || popped < 10 * RETIRE_THRESHOLD)
+        {
+            std::cerr << "FAILURE: Popped " << popped << " of " << COUNT << " keys" << std::endl;
+            return 1;
+        }
+        if (!intact)
+        {
+            std::cerr << "FAILURE: The node the reader held was freed under it" << std::endl;
+            return 1;
+        }
+    }
+
+    if (Tracked::live != 0)
+    {
+        std::cerr << "FAILURE: " << Tracked::live << " values were leaked or freed twice" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <atomic>
+
+#include "CSLPQ/Queue.hpp"
+
+#define WARMUP 4096
+#define ROUND 512
+#define ROUNDS 100
+#define BLOCKS 256
+#define LEVEL 3
+// Low enough that the warmup leaves plenty of blocks of every height, tall ones included
+#define MAX_LEVEL 4
+
+// PoolAllocator keeps reusing the same blocks once a queue has warmed up, whether the thread that pushed a key or
+// another one frees its node. Queues get their nodes through RecordingPool, which remembers every block the pool
+// hands out, so a block it has never handed out before is one it had to get from the system.
+struct RecordingPool
+{
+    static std::mutex mutex;
+    static std::set<void*> seen;
+    static uint64_t fresh;
+
+    template<typename N>
+    static void* Allocate(std::size_t size, int level)
+    {
+        void* memory = CSLPQ::PoolAllocator::Allocate<N>(size, level);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (seen.insert(memory).second)
+        {
+            fresh++;
+        }
+        return memory;
+    }
+
+    template<typename N>
+    static void Free(void* memory)
+    {
+        CSLPQ::PoolAllocator::Free<N>(memory);
+    }
+
+    template<typename N>
+    static void Reserve(std::size_t size, int level, std::size_t count)
+    {
+        CSLPQ::PoolAllocator::Reserve<N>(size, level, count);
+    }
+};
+
+std::mutex RecordingPool::mutex;
+std::set<void*> RecordingPool::seen;
+uint64_t RecordingPool::fresh = 0;
+
+uint64_t GetFresh()
+{
+    std::lock_guard<std::mutex> lock(RecordingPool::mutex);
+    return RecordingPool::fresh;
+}
+
+typedef CSLPQ::Queue<uint64_t, CSLPQ::HazardReclamation, RecordingPool> PooledQueue;
+
+pthread_barrier_t barrier;
+std::atomic<bool> failed;
+
+void push(PooledQueue& queue, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; i++)
+    {
+        queue.Push((i * 7919) % count);
+    }
+}
+
+void pop(PooledQueue& queue, uint64_t count)
+{
+    uint64_t key;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (!queue.TryPop(key))
+        {
+            std::cerr << "FAILURE: Queue empty after " << i << " of " << count << " pops" << std::endl;
+            failed = true;
+            return;
+        }
+    }
+}
+
+// Rounds of pushes on one thread and pops on another, every node freed remotely. fresh is taken once the warmup round
+// is done.
+void producer(PooledQueue& queue, uint64_t& fresh)
+{
+    for (uint64_t round = 0; round <= ROUNDS; round++)
+    {
+        pthread_barrier_wait(&barrier);
+        if (round == 1)
+        {
+            fresh = GetFresh();
+        }
+        push(queue, round ? ROUND : WARMUP);
+        pthread_barrier_wait(&barrier);
+    }
+}
+
+void consumer(PooledQueue& queue)
+{
+    for (uint64_t round = 0; round <= ROUNDS; round++)
+    {
+        pthread_barrier_wait(&barrier);
+        pthread_barrier_wait(&barrier);
+        pop(queue, round ? ROUND : WARMUP);
+    }
+}
+
+struct RemoteTag
+{
+};
+
+int main()
+{
+    failed = false;
+
+    // Pushes and pops on one thread
+    {
+        PooledQueue queue(MAX_LEVEL);
+        push(queue, WARMUP);
+        pop(queue, WARMUP);
+        uint64_t fresh = GetFresh();
+        for (uint64_t round = 0; round < ROUNDS && !failed; round++)
+        {
+            push(queue, ROUND);
+            pop(queue, ROUND);
+        }
+        if (GetFresh() != fresh)
+        {
+            std::cerr << "FAILURE: " << GetFresh() - fresh << " new blocks in steady state" << std::endl;
+            return 1;
+        }
+    }
+
+    // Pushes on one thread and pops on another, the producer gets its blocks back through its remote stack
+    {
+        PooledQueue queue(MAX_LEVEL);
+        pthread_barrier_init(&barrier, NULL, 2);
+        uint64_t fresh = 0;
+        std::thread consumer_thread(consumer, std::ref(queue));
+        std::thread producer_thread(producer, std::ref(queue), std::ref(fresh));
+        producer_thread.join();
+        consumer_thread.join();
+        pthread_barrier_destroy(&barrier);
+        if (failed)
+        {
+            return 1;
+        }
+        if (GetFresh() != fresh)
+        {
+            std::cerr << "FAILURE: " << GetFresh() - fresh << " new blocks in steady state with remote frees"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    // Blocks freed by another thread go back to the pool they came from, not to the one of the thread freeing them
+    {
+        std::vector<void*> blocks;
+        std::set<void*> owned;
+        for (uint64_t i = 0; i < BLOCKS; i++)
+        {
+            blocks.push_back(CSLPQ::PoolAllocator::Allocate<RemoteTag>(64, LEVEL));
+            owned.insert(blocks.back());
+        }
+        std::thread remote([&]()
+        {
+            for (void* block : blocks)
+            {
+                CSLPQ::PoolAllocator::Free<RemoteTag>(block);
+            }
+            std::vector<void*> own;
+            for (uint64_t i = 0; i < BLOCKS; i++)
+            {
+                own.push_back(CSLPQ::PoolAllocator::Allocate<RemoteTag>(64, LEVEL));
+                if (owned.count(own.back()))
+                {
+                    std::cerr << "FAILURE: A block freed remotely went to the freeing thread's pool" << std::endl;
+                    failed = true;
+                }
+            }
+            for (void* block : own)
+            {
+                CSLPQ::PoolAllocator::Free<RemoteTag>(block);
+            }
+        });
+        remote.join();
+        if (failed)
+        {
+            return 1;
+        }
+        for (uint64_t i = 0; i < BLOCKS; i++)
+        {
+            if (!owned.erase(CSLPQ::PoolAllocator::Allocate<RemoteTag>(64, LEVEL)))
+            {
+                std::cerr << "FAILURE: A block freed remotely did not come back to its owner" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
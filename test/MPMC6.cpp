@@ -0,0 +1,137 @@
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include "CSLPQ/Queue.hpp"
+
+#include "Helpers.hpp"
+
+#define COUNT 100000
+
+// Relaxed pops land somewhere near the front instead of on the first key. The consumers drain the whole queue in
+// rounds of one relaxed pop each at once, and between rounds the rank of every popped key is taken among the keys left
+// at the start of the round, which can only overstate it. There is no hard bound on single ranks, but their mean has to
+// stay within the window SkipList::TryClaimSprayed documents. Ranks past consumers - 1 are out of reach of strict pops,
+// some of them prove the pops did spray.
+
+pthread_barrier_t barrier;
+std::atomic<bool> failed;
+
+void pop(CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation>& queue, uint32_t consumers, uint64_t* popped)
+{
+    for (uint64_t round = 0; round < COUNT / consumers; round++)
+    {
+        pthread_barrier_wait(&barrier);
+        if (!queue.TryPopRelaxed(popped[round], consumers))
+        {
+            std::cerr << "FAILURE: Relaxed pop on a full queue came back empty" << std::endl;
+            failed = true;
+        }
+        pthread_barrier_wait(&barrier);
+    }
+}
+
+// The average window SkipList::TryClaimSprayed documents: 2 * p * log2(p), log2(p) rounded up
+uint64_t SprayWindow(uint32_t consumers)
+{
+    uint64_t log = 0;
+    while ((1u << log) < consumers)
+    {
+        log++;
+    }
+    return 2 * consumers * log;
+}
+
+bool run(uint32_t consumers)
+{
+    CSLPQ::Queue<uint64_t, CSLPQ::EpochReclamation> queue(8);
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        keys.emplace_back(i);
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+    queue.PushBatch(keys.begin(), keys.end());
+
+    uint64_t rounds = COUNT / consumers;
+    std::vector<std::vector<uint64_t>> popped(consumers, std::vector<uint64_t>(rounds));
+    pthread_barrier_init(&barrier, NULL, consumers);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < consumers; i++)
+    {
+        threads.emplace_back(pop, std::ref(queue), consumers, popped[i].data());
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    pthread_barrier_destroy(&barrier);
+    uint64_t key;
+    if (failed || queue.TryPop(key))
+    {
+        std::cerr << "FAILURE: Relaxed pops did not drain the queue" << std::endl;
+        return false;
+    }
+
+    Remaining remaining(COUNT);
+    std::vector<bool> taken(COUNT, false);
+    uint64_t window = SprayWindow(consumers);
+    uint64_t sprayed = 0;
+    uint64_t total = 0;
+    uint64_t worst = 0;
+    for (uint64_t round = 0; round < rounds; round++)
+    {
+        for (uint32_t i = 0; i < consumers; i++)
+        {
+            key = popped[i][round];
+            if (key >= COUNT || taken[key])
+            {
+                std::cerr << "FAILURE: Read " << key << " which has already been removed" << std::endl;
+                return false;
+            }
+            taken[key] = true;
+            uint64_t rank = remaining.Rank(key);
+            total += rank;
+            worst = std::max(worst, rank);
+            if (rank >= consumers)
+            {
+                sprayed++;
+            }
+        }
+        for (uint32_t i = 0; i < consumers; i++)
+        {
+            remaining.Update(popped[i][round], -1);
+        }
+    }
+    double mean = double(total) / COUNT;
+    std::cout << consumers << " consumers: mean rank " << mean << " of a window of " << window << ", worst " << worst
+              << ", " << sprayed << " pops off the front" << std::endl;
+    if (mean >= window)
+    {
+        std::cerr << "FAILURE: Mean rank " << mean << " outside the spray window of " << window << " with "
+                  << consumers << " consumers" << std::endl;
+        return false;
+    }
+    if (!sprayed)
+    {
+        std::cerr << "FAILURE: Every relaxed pop took one of the first keys" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    failed = false;
+    for (uint32_t consumers : {2, 8, 32})
+    {
+        if (!run(consumers))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
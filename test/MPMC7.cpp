@@ -0,0 +1,88 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include "CSLPQ/MultiQueue.hpp"
+
+#include "Helpers.hpp"
+
+#define COUNT 200000
+#define THREADS 4
+
+// Rank error of a MultiQueue. Pushers fill it with shuffled keys, shard chosen at random or by thread, and one
+// thread then drains it, taking the rank of every popped key among the keys left. The mean rank is expected to be
+// O(shards), about 0.7 times the shard count, and has to stay below the shard count.
+
+typedef CSLPQ::MultiQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation> Queue;
+
+void insert(Queue& queue, const std::vector<uint64_t>& keys)
+{
+    for (uint64_t key : keys)
+    {
+        queue.Push(key, key);
+    }
+}
+
+bool run(uint32_t shards_per_thread, CSLPQ::PushChoice push_choice)
+{
+    Queue queue(THREADS, shards_per_thread, 8, 0.5, CSLPQ::EpochReclamation::Parameters(), std::less<uint64_t>(),
+                push_choice);
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        keys.emplace_back(i);
+    }
+    std::random_shuffle(keys.begin(), keys.end());
+    std::vector<std::thread> threads;
+    for (uint64_t i = 0; i < THREADS; i++)
+    {
+        threads.emplace_back(insert, std::ref(queue), std::vector<uint64_t>(keys.begin() + i * COUNT / THREADS,
+                                                                            keys.begin() + (i + 1) * COUNT / THREADS));
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    Remaining remaining(COUNT);
+    std::vector<bool> taken(COUNT, false);
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        uint64_t key = 0;
+        uint64_t value = 0;
+        if (!queue.TryPop(key, value) || key != value || key >= COUNT || taken[key])
+        {
+            std::cerr << "FAILURE: Read " << key << ": " << value << " at pop " << i << std::endl;
+            return false;
+        }
+        taken[key] = true;
+        total += remaining.Rank(key);
+        remaining.Update(key, -1);
+    }
+
+    double mean = double(total) / COUNT;
+    std::cout << queue.GetShardCount() << (push_choice == CSLPQ::PushChoice::Random ? " random" : " thread affine")
+              << " shards: mean rank " << mean << std::endl;
+    if (mean >= queue.GetShardCount())
+    {
+        std::cerr << "FAILURE: Mean rank " << mean << " with " << queue.GetShardCount() << " shards" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    for (uint32_t shards_per_thread : {2, 4})
+    {
+        if (!run(shards_per_thread, CSLPQ::PushChoice::Random) ||
+            !run(shards_per_thread, CSLPQ::PushChoice::ThreadAffine))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100000
+#define DONE UINT64_MAX
+
+std::vector<std::vector<uint64_t>> keys;
+std::set<uint64_t> keys_ref;
+std::mutex keys_ref_mutex;
+pthread_barrier_t barrier;
+std::atomic<uint64_t> count;
+std::atomic<bool> failed;
+
+void insert(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation>& queue, std::vector<uint64_t>& local_keys)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < COUNT / 10; i++)
+    {
+        queue.Push(local_keys[i], local_keys[i]);
+    }
+}
+
+bool check(uint64_t key, uint64_t value)
+{
+    count++;
+    std::lock_guard<std::mutex> lock(keys_ref_mutex);
+    if (keys_ref.find(key) == keys_ref.end() || value != key)
+    {
+        std::cerr << "FAILURE: Read " << key << ": " << value << " which has already been removed" << std::endl;
+        failed = true;
+        return false;
+    }
+    keys_ref.erase(key);
+    return true;
+}
+
+// Blocks until it gets the DONE key
+void remove_(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation>& queue)
+{
+    while (true)
+    {
+        uint64_t key = 0;
+        uint64_t value = 0;
+        queue.Pop(key, value);
+        if (key == DONE || !check(key, value))
+        {
+            return;
+        }
+    }
+}
+
+// Wakes up every now and then while the queue is empty, until it gets the DONE key
+void remove_timed(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation>& queue)
+{
+    while (true)
+    {
+        uint64_t key = 0;
+        uint64_t value = 0;
+        if (queue.PopFor(key, value, std::chrono::milliseconds(1)))
+        {
+            if (key == DONE || !check(key, value))
+            {
+                return;
+            }
+        }
+    }
+}
+
+int main()
+{
+    count = 0;
+    failed = false;
+    pthread_barrier_init(&barrier, NULL, 10);
+
+    // First, fill the keys and ref
+    std::vector<uint64_t> full_keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        full_keys.emplace_back(i);
+        keys_ref.insert(i);
+    }
+
+    // Shuffle the keys
+    std::random_shuffle(full_keys.begin(), full_keys.end());
+
+    // Split among threads
+    keys.resize(10);
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        keys[i] = std::vector<uint64_t>(full_keys.begin() + i * COUNT / 10, full_keys.begin() + (i + 1) * COUNT / 10);
+    }
+
+    CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::EpochReclamation> queue(8);
+
+    // Nothing to pop, must time out
+    uint64_t key = 0;
+    uint64_t value = 0;
+    auto start = std::chrono::steady_clock::now();
+    if (queue.PopFor(key, value, std::chrono::milliseconds(20)) ||
+        std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20))
+    {
+        std::cerr << "FAILURE: PopFor on an empty queue did not time out" << std::endl;
+        return 1;
+    }
+
+    // Start the threads
+    std::cout << "Starting threads" << std::endl;
+    std::vector<std::thread> ts;
+    for (uint64_t i = 0; i < 5; i++)
+    {
+        ts.emplace_back(remove_, std::ref(queue));
+        ts.emplace_back(remove_timed, std::ref(queue));
+    }
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ts.emplace_back(insert, std::ref(queue), std::ref(keys[i]));
+    }
+    for (uint64_t i = 10; i < 20; i++)
+    {
+        ts[i].join();
+    }
+
+    // Let the consumers empty the queue before telling them to stop
+    while (count != COUNT && !failed)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        queue.Push(DONE, DONE);
+    }
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ts[i].join();
+    }
+    if (failed)
+    {
+        return 1;
+    }
+    if (!keys_ref.empty() || queue.GetSize())
+    {
+        std::cerr << "FAILURE: " << keys_ref.size() << " keys were never read" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+
+#include "CSLPQ/Queue.hpp"
+
+#define COUNT 100000
+#define BATCH 100
+
+std::vector<std::vector<std::pair<uint64_t, uint64_t>>> keys;
+std::set<uint64_t> keys_ref;
+std::mutex keys_ref_mutex;
+pthread_barrier_t barrier;
+std::atomic<uint64_t> count;
+std::atomic<bool> failed;
+
+void insert(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation>& queue,
+            std::vector<std::pair<uint64_t, uint64_t>>& local_keys)
+{
+    pthread_barrier_wait(&barrier);
+    for (uint64_t i = 0; i < COUNT / 10; i += BATCH)
+    {
+        queue.PushBatch(local_keys.begin() + i, local_keys.begin() + i + BATCH);
+    }
+}
+
+void remove_(CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation>& queue)
+{
+    while (count != COUNT && !failed)
+    {
+        uint64_t key;
+        uint64_t value;
+        if (queue.TryPop(key, value))
+        {
+            count++;
+            keys_ref_mutex.lock();
+            if (keys_ref.find(key) == keys_ref.end() || value != key)
+            {
+                keys_ref_mutex.unlock();
+                std::cerr << "FAILURE: Read " << key << ": " << value << " which has already been removed" << std::endl;
+                failed = true;
+                return;
+            }
+            else
+            {
+                keys_ref.erase(key);
+                keys_ref_mutex.unlock();
+            }
+        }
+    }
+}
+
+int main()
+{
+    count = 0;
+    failed = false;
+    pthread_barrier_init(&barrier, NULL, 10);
+
+    // First, fill the keys and ref
+    std::vector<std::pair<uint64_t, uint64_t>> full_keys;
+    for (uint64_t i = 0; i < COUNT; i++)
+    {
+        full_keys.emplace_back(i, i);
+        keys_ref.insert(i);
+    }
+
+    // Shuffle the keys
+    std::random_shuffle(full_keys.begin(), full_keys.end());
+
+    // A single batch comes out sorted
+    {
+        CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation> queue(8);
+        queue.PushBatch(full_keys.begin(), full_keys.begin() + COUNT / 10);
+        std::vector<uint64_t> sorted;
+        for (uint64_t i = 0; i < COUNT / 10; i++)
+        {
+            sorted.emplace_back(full_keys[i].first);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        for (uint64_t i = 0; i < COUNT / 10; i++)
+        {
+            uint64_t key = 0;
+            uint64_t value = 0;
+            if (!queue.TryPop(key, value) || key != sorted[i] || value != key)
+            {
+                std::cerr << "FAILURE: Expected " << sorted[i] << " but read " << key << ": " << value << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // Split among threads
+    keys.resize(10);
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        keys[i] = std::vector<std::pair<uint64_t, uint64_t>>(full_keys.begin() + i * COUNT / 10,
+                                                             full_keys.begin() + (i + 1) * COUNT / 10);
+    }
+
+    CSLPQ::KVQueue<uint64_t, uint64_t, CSLPQ::HazardReclamation> queue(8, 0, 0.5,
+                                                                       CSLPQ::HazardReclamation::Parameters(16, 4));
+
+    // Start the threads
+    std::cout << "Starting threads" << std::endl;
+    std::vector<std::thread> ts;
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ts.emplace_back(remove_, std::ref(queue));
+    }
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ts.emplace_back(insert, std::ref(queue), std::ref(keys[i]));
+    }
+    for (uint64_t i = 0; i < 20; i++)
+    {
+        ts[i].join();
+    }
+    if (failed)
+    {
+        return 1;
+    }
+    if (!keys_ref.empty() || queue.GetSize())
+    {
+        std::cerr << "FAILURE: " << keys_ref.size() << " keys were never read" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}